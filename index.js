@@ -38,14 +38,13 @@ module.exports.decode = function(data, baseBindingIndex = 0, inputVaryings = [])
   let dataU32 = new Uint32Array(data.buffer);
   if (dataU32[0] === 0x48534E42) {
     let byteCodeOffset = 0x0;
-    for (let ii = 0; ii < dataU32.length; ++ii) {
-      // bytecode section starts with 0x12345678
-      if (dataU32[ii] == 0x12345678) {
-        if (byteCodeOffset != 0x0) {
-          throw new Error(`Unimplemented: Multiple BNSH bytecode sections aren't supported`);
-        }
-        byteCodeOffset = ii * Uint32Array.BYTES_PER_ELEMENT + 0x30;
+    // bytecode section starts with 0x12345678, indexOf scans natively instead of per element
+    let magicIndex = dataU32.indexOf(0x12345678);
+    if (magicIndex !== -1) {
+      if (dataU32.indexOf(0x12345678, magicIndex + 1) !== -1) {
+        throw new Error(`Unimplemented: Multiple BNSH bytecode sections aren't supported`);
       }
+      byteCodeOffset = magicIndex * Uint32Array.BYTES_PER_ELEMENT + 0x30;
     }
     if (byteCodeOffset == 0x0) {
       throw new Error(`Missing BNSH bytecode section`);
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/word_scan.h"
+
+namespace {
+
+constexpr u32 BNSH_MAGIC = 0x48534E42; // BNSH
+constexpr u32 NVN_BYTECODE_MAGIC = 0x12345678;
+
+typedef size_t (*FindFunction)(const void* data, size_t count, u32 first, u32 second);
+
+// synthetic dump of random words with an item header every few KiB, like a capture of many
+// small shaders stored back to back. The seed is fixed so that runs are comparable
+std::vector<u8> GenerateDump(size_t size) {
+  std::vector<u8> dump(size / sizeof(u32) * sizeof(u32));
+  std::mt19937 rng(0x424E5348);
+  for (size_t ii = 0; ii < dump.size(); ii += sizeof(u32)) {
+    u32 word = static_cast<u32>(rng());
+    if (word == BNSH_MAGIC || word == NVN_BYTECODE_MAGIC) word = 0;
+    std::memcpy(dump.data() + ii, &word, sizeof(word));
+  }
+  for (size_t ii = 0; ii + sizeof(u32) <= dump.size(); ii += (2 + rng() % 30) * 1024) {
+    const u32 magic = rng() % 2 ? BNSH_MAGIC : NVN_BYTECODE_MAGIC;
+    std::memcpy(dump.data() + ii, &magic, sizeof(magic));
+  }
+  return dump;
+}
+
+// walks the dump from item to item the way --stream does, returns the number of items
+size_t CountItems(const std::vector<u8>& dump, FindFunction find) {
+  const size_t count = dump.size() / sizeof(u32);
+  size_t items = 0;
+  for (size_t index = 0; index < count; ++index) {
+    index += find(dump.data() + index * sizeof(u32), count - index, BNSH_MAGIC,
+                  NVN_BYTECODE_MAGIC);
+    if (index < count) ++items;
+  }
+  return items;
+}
+
+// best of several runs, in milliseconds
+double Measure(const std::vector<u8>& dump, FindFunction find, size_t& items) {
+  double best = 0.0;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    items = CountItems(dump, find);
+    const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    if (run == 0 || time.count() < best) best = time.count();
+  }
+  return best;
+}
+
+}  // namespace
+
+// usage: word_scan_benchmark [dump file | size in MiB]
+int main(int argc, char** argv) {
+  std::vector<u8> dump;
+  std::string source = "synthetic";
+  size_t sizeMiB = 256;
+  if (argc > 1) {
+    char* end = nullptr;
+    const unsigned long long value = strtoull(argv[1], &end, 10);
+    if (*end == '\0' && value > 0) {
+      sizeMiB = static_cast<size_t>(value);
+    } else {
+      std::ifstream file(argv[1], std::ios::ate | std::ios::binary);
+      if (!file.is_open()) {
+        fprintf(stderr, "%s: Failed to open file!\n", argv[1]);
+        return EXIT_FAILURE;
+      }
+      dump.resize(static_cast<size_t>(file.tellg()));
+      file.seekg(0);
+      file.read(reinterpret_cast<char*>(dump.data()), static_cast<std::streamsize>(dump.size()));
+      source = argv[1];
+    }
+  }
+  if (dump.empty()) dump = GenerateDump(sizeMiB * 1024 * 1024);
+
+  size_t scalarItems = 0;
+  size_t vectorItems = 0;
+  const double scalarTime = Measure(dump, Common::FindWord32Scalar, scalarItems);
+  const double vectorTime = Measure(dump, Common::FindWord32, vectorItems);
+  if (scalarItems != vectorItems) {
+    fprintf(stderr, "Item counts differ: scalar %zu, vectorized %zu\n", scalarItems, vectorItems);
+    return EXIT_FAILURE;
+  }
+
+  const double megabytes = static_cast<double>(dump.size()) / (1024.0 * 1024.0);
+  fprintf(stdout, "%s dump, %.1f MiB, %zu items\n", source.c_str(), megabytes, scalarItems);
+  fprintf(stdout, "scalar:     %8.2f ms %8.1f MiB/s\n", scalarTime, megabytes / scalarTime * 1000.0);
+  fprintf(stdout, "vectorized: %8.2f ms %8.1f MiB/s\n", vectorTime, megabytes / vectorTime * 1000.0);
+  fprintf(stdout, "speedup:    %8.2fx\n", scalarTime / vectorTime);
+  return EXIT_SUCCESS;
+}
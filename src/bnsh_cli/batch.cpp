@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "bnsh_cli/batch.h"
+#include "bnsh_cli/bundle.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/decoder.h"
+#include "bnsh_cli/output_writer.h"
+#include "common/assert.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using VideoCommon::Shader::ProgramCodeView;
+
+typedef struct BatchEntry {
+  fs::path input;
+  // input path relative to the batch root, used to mirror the layout in the output directory
+  fs::path relative;
+} BatchEntry;
+
+// first input of a set of duplicates, the others wait for its json
+typedef struct UniqueProgram {
+  std::mutex mutex;
+  std::condition_variable readyCondition;
+  // set once the first occurrence finished, successfully or not
+  bool ready = false;
+  bool failed = false;
+  // set when the program is claimed
+  fs::path outputBase;
+  std::string bundleName;
+  // json of each variant
+  std::vector<std::string> json;
+} UniqueProgram;
+
+// unique programs of a batch keyed by their decode key
+class DedupTable {
+public:
+  // returns the program registered under key and whether the caller is its first occurrence,
+  // which registers its output names
+  std::pair<std::shared_ptr<UniqueProgram>, bool> Claim(u64 key, const fs::path& outputBase,
+                                                        const std::string& bundleName) {
+    std::lock_guard lock{mutex};
+    auto [it, inserted] = programs.try_emplace(key);
+    if (inserted) {
+      it->second = std::make_shared<UniqueProgram>();
+      it->second->outputBase = outputBase;
+      it->second->bundleName = bundleName;
+    }
+    return { it->second, inserted };
+  }
+
+private:
+  std::mutex mutex;
+  std::unordered_map<u64, std::shared_ptr<UniqueProgram>> programs;
+};
+
+// publishes the outcome of a first occurrence on every exit path, so that its duplicates never
+// wait for a decode which failed or threw
+class ReadyGuard {
+public:
+  explicit ReadyGuard(UniqueProgram* program) : program{program} {}
+  ~ReadyGuard() {
+    if (!program) return;
+    std::lock_guard lock{program->mutex};
+    program->failed = !succeeded;
+    program->ready = true;
+    program->readyCondition.notify_all();
+  }
+
+  ReadyGuard(const ReadyGuard&) = delete;
+  ReadyGuard& operator=(const ReadyGuard&) = delete;
+
+  void Succeed() { succeeded = true; }
+
+private:
+  UniqueProgram* program;
+  bool succeeded = false;
+};
+
+bool IsShaderFile(const fs::path& path) {
+  // matches .bnsh, .bnsh_fsh, .bnsh_vsh, ...
+  return path.extension().string().rfind(".bnsh", 0) == 0;
+}
+
+bool CollectBatchEntries(const fs::path& root, std::vector<BatchEntry>& entries) {
+  std::error_code ec;
+  if (fs::is_directory(root, ec)) {
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+      if (!it->is_regular_file(ec) || !IsShaderFile(it->path())) continue;
+      entries.push_back({ it->path(), it->path().lexically_relative(root) });
+    }
+    if (ec) {
+      fprintf(stderr, "%s: Failed to walk directory: %s\n", root.string().c_str(), ec.message().c_str());
+      return false;
+    }
+    // keep reports and outputs stable between runs
+    std::sort(entries.begin(), entries.end(), [](const BatchEntry& a, const BatchEntry& b) {
+      return a.input < b.input;
+    });
+    return true;
+  }
+  // manifest, one input per line, relative paths resolve against the manifest location
+  std::ifstream manifest(root);
+  if (!manifest.is_open()) {
+    fprintf(stderr, "%s: Failed to open batch input!\n", root.string().c_str());
+    return false;
+  }
+  const fs::path base = root.parent_path();
+  std::string line;
+  while (std::getline(manifest, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+    fs::path input(line);
+    if (input.is_relative()) input = base / input;
+    fs::path relative = input.lexically_relative(base);
+    // inputs outside the manifest directory are flattened into the output directory
+    if (relative.empty() || *relative.begin() == "..") relative = input.filename();
+    entries.push_back({ input, relative });
+  }
+  return true;
+}
+
+// decodes an entry into the outputs to write, returns false if it failed
+bool DecodeBatchEntry(const BatchEntry& entry, const BatchOptions& options, DedupTable* dedup,
+                      std::vector<OutputWriter::Output>& outputs, bool& duplicate,
+                      ShaderStats* stats) {
+  const auto extractStart = std::chrono::steady_clock::now();
+  std::optional<ProgramSource> source = LoadFileProgramCode(entry.input.string(), false);
+  if (!source) return false;
+  ProgramCodeView code = source->Code();
+  const BNSHStageReflection* reflection = source->reflection ? &*source->reflection : nullptr;
+  if (stats) stats->extract = std::chrono::steady_clock::now() - extractStart;
+
+  fs::path outputBase = entry.input;
+  if (!options.bundle && options.outputDir.size()) {
+    outputBase = fs::path(options.outputDir) / entry.relative;
+    std::error_code ec;
+    fs::create_directories(outputBase.parent_path(), ec);
+  }
+  const std::string bundleName = entry.relative.generic_string();
+
+  std::shared_ptr<UniqueProgram> unique;
+  if (dedup) {
+    // the key of the first variant covers the bytecode and reflection, the variants are the
+    // same for every input
+    auto [program, first] = dedup->Claim(
+      ComputeDecodeKey(code, options.variants.front(), reflection), outputBase, bundleName);
+    if (first) {
+      unique = std::move(program);
+    } else {
+      duplicate = true;
+      std::unique_lock lock{program->mutex};
+      program->readyCondition.wait(lock, [&] { return program->ready; });
+      // nothing was written which could be referenced
+      if (program->failed) {
+        fprintf(stderr, "%s: Duplicate of a shader which failed to decode\n",
+                entry.input.string().c_str());
+        return false;
+      }
+      bool success = true;
+      if (options.bundle) {
+        for (const DecodeVariant& variant : options.variants) {
+          success &= options.bundle->AddShared(bundleName + variant.suffix,
+                                               program->bundleName + variant.suffix);
+        }
+        return success;
+      }
+      // reference the spirv of the first occurrence relative to this json
+      std::error_code ec;
+      const fs::path directory = fs::absolute(outputBase, ec).parent_path();
+      for (size_t ii = 0; ii < options.variants.size(); ++ii) {
+        const std::string& suffix = options.variants[ii].suffix;
+        const fs::path spirvFile =
+          fs::absolute(program->outputBase.string() + suffix + ".spv", ec).lexically_relative(directory);
+        OutputWriter::Output& output = outputs.emplace_back();
+        output.jsonFile = outputBase.string() + suffix + ".json";
+        output.output.json = GenerateDuplicateJSON(program->json[ii], spirvFile.generic_string());
+      }
+      return success;
+    }
+  }
+
+  ReadyGuard readyGuard(unique.get());
+  std::vector<DecodeOutput> results;
+  // a shader the decoder rejects only fails itself, not the whole batch
+  try {
+    Common::ScopedRecoverableAsserts recoverableAsserts;
+    results = DecodeShaderVariantsCached(options.cache, code, options.variants, reflection, stats);
+  } catch (const Common::AssertionFailure&) {
+    return false;
+  } catch (const std::exception& e) {
+    fprintf(stderr, "%s: %s\n", entry.input.string().c_str(), e.what());
+    return false;
+  }
+
+  if (unique && !options.bundle) {
+    std::lock_guard lock{unique->mutex};
+    for (const DecodeOutput& result : results) unique->json.push_back(result.json);
+  }
+
+  for (size_t ii = 0; ii < results.size(); ++ii) {
+    const std::string& suffix = options.variants[ii].suffix;
+    OutputWriter::Output& output = outputs.emplace_back();
+    if (options.bundle) {
+      output.bundleName = bundleName + suffix;
+    } else {
+      // keep the full input name so that shader.bnsh_vsh and shader.bnsh_fsh don't collide
+      output.jsonFile = outputBase.string() + suffix + ".json";
+      output.spirvFile = outputBase.string() + suffix + ".spv";
+    }
+    output.output = std::move(results[ii]);
+  }
+  // duplicates in a bundle share the blobs added by the writer
+  readyGuard.Succeed();
+  return true;
+}
+
+}  // namespace
+
+int RunBatch(const BatchOptions& options) {
+  std::vector<BatchEntry> entries;
+  if (!CollectBatchEntries(options.input, entries)) return EXIT_FAILURE;
+
+  uint32_t jobs = options.jobs ? options.jobs : std::thread::hardware_concurrency();
+  jobs = std::max(1u, std::min<uint32_t>(jobs, static_cast<uint32_t>(entries.size())));
+
+  std::atomic<size_t> nextEntry{0};
+  std::atomic<size_t> failures{0};
+  std::atomic<size_t> duplicates{0};
+  std::vector<ShaderStats> stats(options.statsFile.size() ? entries.size() : 0);
+  // outputs are written behind the decoders, a few pending inputs per worker is enough to keep
+  // the disk busy
+  OutputWriter writer(jobs * 4, options.bundle);
+  std::optional<DedupTable> dedup;
+  if (options.dedup) dedup.emplace();
+
+  const auto worker = [&]() {
+    for (size_t ii = nextEntry++; ii < entries.size(); ii = nextEntry++) {
+      const BatchEntry& entry = entries[ii];
+      ShaderStats* entryStats = stats.size() ? &stats[ii] : nullptr;
+      if (entryStats) entryStats->name = entry.input.generic_string();
+      std::vector<OutputWriter::Output> outputs;
+      bool duplicate = false;
+      const bool decoded = DecodeBatchEntry(entry, options, dedup ? &*dedup : nullptr, outputs,
+                                            duplicate, entryStats);
+      if (duplicate) ++duplicates;
+      // an input is reported once its outputs are written, the writer runs one report at a time
+      writer.Write(std::move(outputs), [&, decoded, duplicate, entryStats](bool written) {
+        const bool success = decoded && written;
+        if (entryStats) {
+          entryStats->duplicate = duplicate;
+          entryStats->success = success;
+        }
+        if (!success) ++failures;
+        fprintf(success ? stdout : stderr, "%s %s\n", success ? "[OK]" : "[FAILED]",
+                entry.input.string().c_str());
+      });
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t ii = 1; ii < jobs; ++ii) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  writer.Finish();
+
+  if (options.bundle && !options.bundle->Finish()) return EXIT_FAILURE;
+
+  if (options.statsFile.size()) {
+    const std::string json = GenerateStatsJSON(stats);
+    if (!WriteOutputFile(options.statsFile, json.data(), json.size())) return EXIT_FAILURE;
+  }
+
+  fprintf(stdout, "Decoded %zu of %zu shaders using %u threads\n", entries.size() - failures,
+          entries.size(), jobs);
+  if (dedup) fprintf(stdout, "%zu shaders were duplicates\n", duplicates.load());
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
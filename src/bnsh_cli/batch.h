@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bnsh_cli/decoder.h"
+#include "common/common_types.h"
+
+class BundleWriter;
+class DecodeCache;
+
+typedef struct BatchOptions {
+  // directory to walk or manifest file listing one input per line
+  std::string input;
+  // writes outputs next to each input if empty
+  std::string outputDir;
+  // number of worker threads, 0 picks the hardware concurrency
+  uint32_t jobs = 0;
+  // specializations emitted for each input, decoded from a single ir build
+  std::vector<DecodeVariant> variants{};
+  // optional decode result cache shared by all workers
+  const DecodeCache* cache = nullptr;
+  // packs all results into an opened bundle instead of writing loose files
+  BundleWriter* bundle = nullptr;
+  // writes per shader phase timings as json if set
+  std::string statsFile;
+  // decodes inputs with identical bytecode and reflection only once, the others reference the
+  // spirv of the first one
+  bool dedup = false;
+} BatchOptions;
+
+// decodes every input of a directory or manifest, returns the process exit code
+int RunBatch(const BatchOptions& options);
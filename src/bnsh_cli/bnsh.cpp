@@ -0,0 +1,180 @@
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bnsh_cli/bnsh.h"
+#include "bnsh_cli/bundle_format.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/decoder.h"
+#include "common/assert.h"
+#include "common/common_types.h"
+
+using VideoCommon::Shader::ProgramCode;
+using VideoCommon::Shader::ProgramCodeView;
+
+struct bnsh_context {
+  std::optional<DecodeCache> cache;
+  // u64 aligned copy of inputs that can't be decoded in place, reused between decodes
+  ProgramCode scratch;
+  std::vector<u8> inputVaryings;
+  std::string lastError;
+};
+
+namespace {
+
+typedef struct ResultStorage : bnsh_result {
+  DecodeOutput output;
+} ResultStorage;
+
+bnsh_status Fail(bnsh_context* context, bnsh_status status, const char* message) {
+  context->lastError = message;
+  return status;
+}
+
+bnsh_status Decode(bnsh_context* context, const void* data, size_t size,
+                   const ProgramSelection* selection, const bnsh_decode_options* options,
+                   bnsh_result** out_result) {
+  if (!context) return BNSH_ERROR_INVALID_ARGUMENT;
+  context->lastError.clear();
+  if (!data || !out_result) return Fail(context, BNSH_ERROR_INVALID_ARGUMENT, "Missing argument");
+  *out_result = nullptr;
+  if (options && options->input_varying_count && !options->input_varyings) {
+    return Fail(context, BNSH_ERROR_INVALID_ARGUMENT, "Missing input varyings");
+  }
+  // bindings are emitted as u8, a larger base would silently wrap around
+  if (options && options->base_binding_index > UINT8_MAX) {
+    return Fail(context, BNSH_ERROR_INVALID_ARGUMENT, "Base binding index exceeds 255");
+  }
+
+  const u8* bytes = static_cast<const u8*>(data);
+  std::optional<BNSHProgramCode> program;
+  std::string error;
+  std::optional<size_t> offset =
+    FindProgramCodeOffset(bytes, size, "bnsh_decode", false, &program, selection, &error);
+  if (!offset) return Fail(context, BNSH_ERROR_UNSUPPORTED_DATA, error.c_str());
+  // programs found in the container end with the program, anything else runs to the end of the
+  // data. The decoder reads the whole header and the first instructions unchecked
+  const size_t codeSize = program ? program->size : size - *offset;
+  if (codeSize < MIN_PROGRAM_SIZE) {
+    return Fail(context, BNSH_ERROR_UNSUPPORTED_DATA, "Truncated shader program");
+  }
+
+  try {
+    // decode in place when the caller's memory allows it
+    ProgramCodeView code;
+    const u8* codeData = bytes + *offset;
+    if (reinterpret_cast<uintptr_t>(codeData) % alignof(u64) == 0) {
+      code = ProgramCodeView(reinterpret_cast<const u64*>(codeData), codeSize / sizeof(u64));
+    } else {
+      context->scratch.assign((codeSize + sizeof(u64) - 1) / sizeof(u64), 0);
+      std::memcpy(context->scratch.data(), codeData, codeSize);
+      code = context->scratch;
+    }
+
+    context->inputVaryings.clear();
+    if (options) {
+      context->inputVaryings.assign(options->input_varyings,
+                                    options->input_varyings + options->input_varying_count);
+    }
+
+    auto result = std::make_unique<ResultStorage>();
+    {
+      Common::ScopedRecoverableAsserts recoverableAsserts;
+      result->output = DecodeShaderCached(
+        context->cache ? &*context->cache : nullptr, code,
+        static_cast<uint8_t>(options ? options->base_binding_index : 0),
+        context->inputVaryings
+      );
+    }
+    result->spirv = result->output.spirv.data();
+    result->spirv_size = result->output.spirv.size();
+    result->json = result->output.json.c_str();
+    result->json_size = result->output.json.size();
+    *out_result = result.release();
+    return BNSH_OK;
+  } catch (const std::bad_alloc&) {
+    return Fail(context, BNSH_ERROR_OUT_OF_MEMORY, "Out of memory");
+  } catch (const std::exception& e) {
+    return Fail(context, BNSH_ERROR_DECODE_FAILED, e.what());
+  }
+}
+
+}  // namespace
+
+bnsh_status bnsh_context_create(const char* cache_dir, bnsh_context** out_context) {
+  if (!out_context) return BNSH_ERROR_INVALID_ARGUMENT;
+  *out_context = nullptr;
+  bnsh_context* context = new (std::nothrow) bnsh_context();
+  if (!context) return BNSH_ERROR_OUT_OF_MEMORY;
+  if (cache_dir && *cache_dir) context->cache.emplace(cache_dir);
+  *out_context = context;
+  return BNSH_OK;
+}
+
+void bnsh_context_destroy(bnsh_context* context) {
+  delete context;
+}
+
+bnsh_status bnsh_decode(bnsh_context* context, const void* data, size_t size,
+                        const bnsh_decode_options* options, bnsh_result** out_result) {
+  return Decode(context, data, size, nullptr, options, out_result);
+}
+
+bnsh_status bnsh_decode_program(bnsh_context* context, const void* data, size_t size,
+                                uint32_t variation, bnsh_stage stage,
+                                const bnsh_decode_options* options, bnsh_result** out_result) {
+  if (stage < BNSH_STAGE_VERTEX || stage > BNSH_STAGE_COMPUTE) {
+    if (out_result) *out_result = nullptr;
+    return context ? Fail(context, BNSH_ERROR_INVALID_ARGUMENT, "Invalid stage")
+                   : BNSH_ERROR_INVALID_ARGUMENT;
+  }
+  ProgramSelection selection{};
+  selection.variation = variation;
+  selection.stage = static_cast<BNSHStage>(stage);
+  return Decode(context, data, size, &selection, options, out_result);
+}
+
+void bnsh_result_free(bnsh_result* result) {
+  delete static_cast<ResultStorage*>(result);
+}
+
+bnsh_status bnsh_bundle_find(const void* data, size_t size, const char* name, size_t name_size,
+                             bnsh_bundle_entry* out_entry) {
+  if (!data || (!name && name_size) || !out_entry) return BNSH_ERROR_INVALID_ARGUMENT;
+  *out_entry = {};
+  const u8* bytes = static_cast<const u8*>(data);
+  if (!IsValidBundle(bytes, size)) return BNSH_ERROR_UNSUPPORTED_DATA;
+  const BundleEntry* entry = FindBundleEntry(bytes, size, std::string_view(name, name_size));
+  if (!entry) return BNSH_ERROR_NOT_FOUND;
+  out_entry->spirv = reinterpret_cast<const uint32_t*>(bytes + entry->spirvOffset);
+  out_entry->spirv_size = entry->spirvSize / sizeof(u32);
+  out_entry->json = reinterpret_cast<const char*>(bytes + entry->jsonOffset);
+  out_entry->json_size = entry->jsonSize;
+  return BNSH_OK;
+}
+
+const char* bnsh_context_last_error(const bnsh_context* context) {
+  return context ? context->lastError.c_str() : "";
+}
+
+const char* bnsh_status_string(bnsh_status status) {
+  switch (status) {
+    case BNSH_OK:
+      return "Success";
+    case BNSH_ERROR_INVALID_ARGUMENT:
+      return "Invalid argument";
+    case BNSH_ERROR_UNSUPPORTED_DATA:
+      return "Unsupported data";
+    case BNSH_ERROR_DECODE_FAILED:
+      return "Decode failed";
+    case BNSH_ERROR_OUT_OF_MEMORY:
+      return "Out of memory";
+    case BNSH_ERROR_NOT_FOUND:
+      return "Not found";
+  }
+  return "Unknown error";
+}
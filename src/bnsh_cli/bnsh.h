@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C interface of the decoder, for embedding it without spawning the CLI per shader.
+//
+// A context holds the state reused between decodes and must only be used by one thread at a
+// time, create one context per thread to decode concurrently. Decode failures are reported
+// through the returned status and leave the context usable.
+
+#if defined(__GNUC__)
+#define BNSH_API __attribute__((visibility("default")))
+#else
+#define BNSH_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum bnsh_status {
+  BNSH_OK = 0,
+  BNSH_ERROR_INVALID_ARGUMENT = 1,
+  // not a bnsh file or bytecode section
+  BNSH_ERROR_UNSUPPORTED_DATA = 2,
+  // the decoder rejected the shader, see bnsh_context_last_error
+  BNSH_ERROR_DECODE_FAILED = 3,
+  BNSH_ERROR_OUT_OF_MEMORY = 4,
+  // the bundle has no entry of that name
+  BNSH_ERROR_NOT_FOUND = 5,
+} bnsh_status;
+
+typedef struct bnsh_context bnsh_context;
+
+// in the order of the stage programs of a bnsh variation
+typedef enum bnsh_stage {
+  BNSH_STAGE_VERTEX = 0,
+  BNSH_STAGE_HULL = 1,
+  BNSH_STAGE_DOMAIN = 2,
+  BNSH_STAGE_GEOMETRY = 3,
+  BNSH_STAGE_FRAGMENT = 4,
+  BNSH_STAGE_COMPUTE = 5,
+} bnsh_stage;
+
+typedef struct bnsh_decode_options {
+  // at most 255
+  uint32_t base_binding_index;
+  // custom input varying locations, may be null if input_varying_count is 0
+  const uint8_t* input_varyings;
+  uint32_t input_varying_count;
+} bnsh_decode_options;
+
+typedef struct bnsh_result {
+  const uint32_t* spirv;
+  // in 32 bit words
+  size_t spirv_size;
+  // reflection json, null terminated
+  const char* json;
+  size_t json_size;
+} bnsh_result;
+
+// cache_dir is optional, if set decode results are stored and reused like with --cache-dir
+BNSH_API bnsh_status bnsh_context_create(const char* cache_dir, bnsh_context** out_context);
+BNSH_API void bnsh_context_destroy(bnsh_context* context);
+
+// decodes a bnsh file or raw bytecode section, options may be null for the defaults
+BNSH_API bnsh_status bnsh_decode(bnsh_context* context, const void* data, size_t size,
+                                 const bnsh_decode_options* options, bnsh_result** out_result);
+// decodes the program of one stage of a variation of a bnsh file, only the data of that program is
+// read. Fails with BNSH_ERROR_UNSUPPORTED_DATA if the variation has no such program
+BNSH_API bnsh_status bnsh_decode_program(bnsh_context* context, const void* data, size_t size,
+                                         uint32_t variation, bnsh_stage stage,
+                                         const bnsh_decode_options* options,
+                                         bnsh_result** out_result);
+BNSH_API void bnsh_result_free(bnsh_result* result);
+
+// spirv and json of a bundle entry, pointing into the bundle
+typedef struct bnsh_bundle_entry {
+  const uint32_t* spirv;
+  // in 32 bit words
+  size_t spirv_size;
+  // reflection json, not null terminated
+  const char* json;
+  size_t json_size;
+} bnsh_bundle_entry;
+
+// looks up the entry of a shader in a bundle written with --output-bundle, without a context. The
+// bundle must be mapped at an 8 byte aligned address and outlive the use of the entry. Fails with
+// BNSH_ERROR_UNSUPPORTED_DATA if data isn't a valid bundle
+BNSH_API bnsh_status bnsh_bundle_find(const void* data, size_t size, const char* name,
+                                      size_t name_size, bnsh_bundle_entry* out_entry);
+
+// message of the last failed call on this context, empty if there was none
+BNSH_API const char* bnsh_context_last_error(const bnsh_context* context);
+BNSH_API const char* bnsh_status_string(bnsh_status status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,303 @@
+#include <cstring>
+#include <optional>
+
+#include <fmt/format.h>
+
+#include "bnsh_cli/bnsh_file.h"
+
+namespace {
+
+constexpr u16 BYTE_ORDER_MARK = 0xFEFF;
+constexpr u32 GRSC_MAGIC = 0x63737267; // grsc
+constexpr u32 STRING_MAGIC = 0x5254535F; // _STR
+constexpr u32 DICTIONARY_MAGIC = 0x4349445F; // _DIC
+
+constexpr size_t HEADER_SIZE = 0x20;
+constexpr size_t BLOCK_HEADER_SIZE = 0x10;
+constexpr size_t GRSC_SIZE = BLOCK_HEADER_SIZE + 0x50;
+constexpr size_t VARIATION_SIZE = 0x40;
+constexpr size_t SHADER_INFO_SIZE = 0x60;
+constexpr size_t STAGE_CODE_SIZE = 0x18;
+constexpr size_t PROGRAM_SIZE = SHADER_INFO_SIZE + 0x50;
+constexpr size_t REFLECTION_SIZE = 0x40;
+constexpr size_t STAGE_REFLECTION_SIZE = 0x58;
+// the root entry of a dictionary is skipped, every entry holds the offset of its name
+constexpr size_t DICTIONARY_HEADER_SIZE = 0x20;
+constexpr size_t DICTIONARY_ENTRY_SIZE = 0x10;
+// bounds the block walk of damaged files whose blocks link in a cycle
+constexpr u32 MAX_BLOCK_COUNT = 64;
+
+// bounds checked little endian reads of the file
+class FileView {
+public:
+  FileView(const u8* data, size_t size) : data{data}, size{size} {}
+
+  bool Contains(u64 offset, u64 length) const {
+    return offset <= size && length <= size - offset;
+  }
+
+  template <typename T>
+  std::optional<T> Read(u64 offset) const {
+    if (!Contains(offset, sizeof(T))) return std::nullopt;
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+  }
+
+private:
+  const u8* data;
+  size_t size;
+};
+
+}  // namespace
+
+std::optional<BNSHStage> ParseBNSHStage(std::string_view name) {
+  for (u32 ii = 0; ii < static_cast<u32>(BNSHStage::Count); ++ii) {
+    if (name == GetBNSHStageName(static_cast<BNSHStage>(ii))) return static_cast<BNSHStage>(ii);
+  }
+  return std::nullopt;
+}
+
+const char* GetBNSHStageName(BNSHStage stage) {
+  switch (stage) {
+    case BNSHStage::Vertex:
+      return "vertex";
+    case BNSHStage::Hull:
+      return "hull";
+    case BNSHStage::Domain:
+      return "domain";
+    case BNSHStage::Geometry:
+      return "geometry";
+    case BNSHStage::Fragment:
+      return "fragment";
+    case BNSHStage::Compute:
+      return "compute";
+    default:
+      return "unknown";
+  }
+}
+
+bool ReadBNSHIndex(const u8* data, size_t dataSize, BNSHIndex& index, std::string& error) {
+  const FileView file(data, dataSize);
+
+  if (!file.Contains(0, HEADER_SIZE) || *file.Read<u32>(0x00) != BNSH_MAGIC) {
+    error = "Missing BNSH header";
+    return false;
+  }
+  if (*file.Read<u16>(0x0C) != BYTE_ORDER_MARK) {
+    error = "Unsupported byte order";
+    return false;
+  }
+  const u32 fileSize = *file.Read<u32>(0x1C);
+  if (fileSize > dataSize) {
+    error = fmt::format("Truncated file, expected 0x{:X} bytes", fileSize);
+    return false;
+  }
+
+  // the file name points at the characters of a string block entry, behind its u16 length
+  const u32 nameOffset = *file.Read<u32>(0x10);
+  std::optional<std::string_view> name;
+
+  // find the grsc block and the string block holding the file name
+  std::optional<u64> grscOffset;
+  u64 blockOffset = *file.Read<u16>(0x16);
+  for (u32 ii = 0; ii < MAX_BLOCK_COUNT; ++ii) {
+    std::optional<u32> magic = file.Read<u32>(blockOffset);
+    std::optional<u32> nextBlock = file.Read<u32>(blockOffset + 0x04);
+    std::optional<u32> blockSize = file.Read<u32>(blockOffset + 0x08);
+    if (!magic || !nextBlock || !blockSize) break;
+    if (*magic == GRSC_MAGIC && !grscOffset) grscOffset = blockOffset;
+    // the block size comes from the file, so the string block must lie within it
+    if (*magic == STRING_MAGIC && !name && file.Contains(blockOffset, *blockSize) &&
+        nameOffset >= blockOffset + BLOCK_HEADER_SIZE + sizeof(u16) &&
+        nameOffset <= blockOffset + *blockSize) {
+      const std::optional<u16> length = file.Read<u16>(nameOffset - sizeof(u16));
+      if (length && file.Contains(nameOffset, *length) &&
+          nameOffset + *length <= blockOffset + *blockSize) {
+        name = std::string_view(reinterpret_cast<const char*>(data + nameOffset), *length);
+      }
+    }
+    if (*nextBlock == 0) break;
+    blockOffset += *nextBlock;
+  }
+  if (!grscOffset) {
+    error = "Missing grsc block";
+    return false;
+  }
+  if (!file.Contains(*grscOffset, GRSC_SIZE)) {
+    error = "Truncated grsc block";
+    return false;
+  }
+
+  BNSHIndex out{};
+  out.variationCount = *file.Read<u32>(*grscOffset + BLOCK_HEADER_SIZE + 0x0C);
+  out.variationArray = *file.Read<u64>(*grscOffset + BLOCK_HEADER_SIZE + 0x10);
+  if (!file.Contains(out.variationArray, static_cast<u64>(out.variationCount) * VARIATION_SIZE)) {
+    error = "Shader variation array out of bounds";
+    return false;
+  }
+
+  if (name) out.name = *name;
+
+  index = std::move(out);
+  return true;
+}
+
+bool FindBNSHProgramCode(const u8* data, size_t dataSize, const BNSHIndex& index, u32 variation,
+                         std::optional<BNSHStage> stage, std::optional<BNSHProgramCode>& code,
+                         std::string& error) {
+  const FileView file(data, dataSize);
+  code.reset();
+  if (variation >= index.variationCount) {
+    error = fmt::format("Variation {} out of range, the file has {}", variation,
+                        index.variationCount);
+    return false;
+  }
+
+  const u64 program = *file.Read<u64>(index.variationArray + variation * VARIATION_SIZE + 0x10);
+  // variations without a binary program only carry source or intermediate code
+  if (program == 0) return true;
+  if (!file.Contains(program, PROGRAM_SIZE)) {
+    error = fmt::format("Variation {}: shader program out of bounds", variation);
+    return false;
+  }
+  const u64 reflection = *file.Read<u64>(program + SHADER_INFO_SIZE + 0x18);
+  if (reflection != 0 && !file.Contains(reflection, REFLECTION_SIZE)) {
+    error = fmt::format("Variation {}: shader reflection out of bounds", variation);
+    return false;
+  }
+
+  for (u32 ii = 0; ii < static_cast<u32>(BNSHStage::Count); ++ii) {
+    if (stage && static_cast<u32>(*stage) != ii) continue;
+    const u64 stageCode = *file.Read<u64>(program + 0x08 + ii * sizeof(u64));
+    if (stageCode == 0) continue;
+    const char* stageName = GetBNSHStageName(static_cast<BNSHStage>(ii));
+    if (!file.Contains(stageCode, STAGE_CODE_SIZE)) {
+      error = fmt::format("Variation {}: {} code out of bounds", variation, stageName);
+      return false;
+    }
+    const u64 codeOffset = *file.Read<u64>(stageCode + 0x08);
+    const u32 codeSize = *file.Read<u32>(stageCode + 0x10);
+    if (codeSize < NVN_BYTECODE_HEADER_SIZE || !file.Contains(codeOffset, codeSize) ||
+        *file.Read<u32>(codeOffset) != NVN_BYTECODE_MAGIC) {
+      error = fmt::format("Variation {}: invalid {} bytecode", variation, stageName);
+      return false;
+    }
+    BNSHProgramCode out{};
+    out.variation = variation;
+    out.stage = static_cast<BNSHStage>(ii);
+    out.offset = codeOffset + NVN_BYTECODE_HEADER_SIZE;
+    out.size = codeSize - NVN_BYTECODE_HEADER_SIZE;
+    out.reflectionOffset = reflection ? *file.Read<u64>(reflection + ii * sizeof(u64)) : 0;
+    code = out;
+    return true;
+  }
+  return true;
+}
+
+bool ReadBNSHProgramCodes(const u8* data, size_t dataSize, std::vector<BNSHProgramCode>& codes,
+                          std::string& error) {
+  BNSHIndex index{};
+  if (!ReadBNSHIndex(data, dataSize, index, error)) return false;
+
+  std::vector<BNSHProgramCode> out;
+  for (u32 variation = 0; variation < index.variationCount; ++variation) {
+    for (u32 stage = 0; stage < static_cast<u32>(BNSHStage::Count); ++stage) {
+      std::optional<BNSHProgramCode> code;
+      if (!FindBNSHProgramCode(data, dataSize, index, variation, static_cast<BNSHStage>(stage),
+                               code, error)) {
+        return false;
+      }
+      if (code) out.push_back(*code);
+    }
+  }
+  if (out.empty()) {
+    error = "No binary shader programs";
+    return false;
+  }
+
+  codes = std::move(out);
+  return true;
+}
+
+bool ReadBNSHStageReflection(const u8* data, size_t dataSize, const BNSHProgramCode& code,
+                             BNSHStageReflection& reflection, std::string& error) {
+  const FileView file(data, dataSize);
+  const u64 offset = code.reflectionOffset;
+  if (offset == 0) {
+    error = "Missing stage reflection";
+    return false;
+  }
+  if (!file.Contains(offset, STAGE_REFLECTION_SIZE)) {
+    error = "Stage reflection out of bounds";
+    return false;
+  }
+
+  // the slot array holds the inputs, outputs, samplers, constant buffers and unordered access
+  // buffers back to back, each dictionary but the inputs has a start index into it. Like every
+  // other offset of the file its pointer is 64-bit, which moves the workgroup size to 0x40
+  const u64 slotArray = *file.Read<u64>(offset + 0x38);
+  const auto readResources = [&](u64 dictionaryField, std::optional<u64> startField,
+                                 BNSHResourceList& resources) {
+    const u64 dictionary = *file.Read<u64>(offset + dictionaryField);
+    if (dictionary == 0) return true;
+    if (file.Read<u32>(dictionary) != DICTIONARY_MAGIC) return false;
+    const std::optional<s32> count = file.Read<s32>(dictionary + 0x04);
+    const s32 start = startField ? *file.Read<s32>(offset + *startField) : 0;
+    if (!count || *count < 0 || start < 0 ||
+        !file.Contains(dictionary + DICTIONARY_HEADER_SIZE,
+                       static_cast<u64>(*count) * DICTIONARY_ENTRY_SIZE) ||
+        !file.Contains(slotArray + static_cast<u64>(start) * sizeof(s32),
+                       static_cast<u64>(*count) * sizeof(s32))) {
+      return false;
+    }
+    for (s32 ii = 0; ii < *count; ++ii) {
+      // the name is a u16 length followed by the characters
+      const u64 key = *file.Read<u64>(dictionary + DICTIONARY_HEADER_SIZE +
+                                      static_cast<u64>(ii) * DICTIONARY_ENTRY_SIZE);
+      const std::optional<u16> length = file.Read<u16>(key);
+      if (!length || !file.Contains(key + sizeof(u16), *length)) return false;
+    }
+    resources = BNSHResourceList(data, dictionary + DICTIONARY_HEADER_SIZE,
+                                 slotArray + static_cast<u64>(start) * sizeof(s32),
+                                 static_cast<u32>(*count));
+    return true;
+  };
+
+  BNSHStageReflection out{};
+  const struct {
+    u64 dictionaryField;
+    std::optional<u64> startField;
+    BNSHResourceList* resources;
+    const char* name;
+  } dictionaries[] = {
+    { 0x00, std::nullopt, &out.inputs, "input" },
+    { 0x08, 0x28, &out.outputs, "output" },
+    { 0x10, 0x2C, &out.samplers, "sampler" },
+    { 0x18, 0x30, &out.constantBuffers, "constant buffer" },
+    { 0x20, 0x34, &out.unorderedAccessBuffers, "unordered access buffer" },
+    { 0x50, 0x4C, &out.images, "image" },
+  };
+  for (const auto& dictionary : dictionaries) {
+    if (!readResources(dictionary.dictionaryField, dictionary.startField, *dictionary.resources)) {
+      error = fmt::format("Invalid {} reflection", dictionary.name);
+      return false;
+    }
+  }
+  for (u32 ii = 0; ii < 3; ++ii) {
+    out.workgroupSize[ii] = *file.Read<u32>(offset + 0x40 + ii * sizeof(u32));
+  }
+  reflection = out;
+  return true;
+}
+
+BNSHResource BNSHResourceList::operator[](size_t index) const {
+  u64 key;
+  std::memcpy(&key, data + entries + index * DICTIONARY_ENTRY_SIZE, sizeof(key));
+  u16 length;
+  std::memcpy(&length, data + key, sizeof(length));
+  BNSHResource resource{};
+  resource.name = std::string_view(reinterpret_cast<const char*>(data + key + sizeof(u16)), length);
+  std::memcpy(&resource.slot, data + slots + index * sizeof(s32), sizeof(resource.slot));
+  return resource;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/common_types.h"
+
+// Reader for the BNSH container (see BNSH.ksy). All offsets stored in the file are relative to
+// the start of the file:
+//
+//   header            ofs_first_block -> block chain, ofs_file_name -> _STR block entry
+//   grsc block        shader_variation_count, ofs_shader_variation_array
+//   _STR block        u16 length prefixed names of the file and the reflection dictionaries
+//   variation         ofs_binary_program -> shader_program_data
+//   program data      shader_info_data with one ofs_*_shader_code per stage
+//   stage code        ofs_data -> nvn bytecode, a 0x30 byte header starting with 0x12345678
+//                     followed by the shader program header and the instructions
+//   reflection        ofs_shader_reflection of the program data, one stage reflection per stage
+//                     with the resource dictionaries and the shader slot array
+//
+// The offsets are stored unrelocated, the relocation table only lists where a loader rebases them
+// into pointers. The reader resolves every offset against the file data on access instead, so
+// structures are read in place from a mapped file without a relocation pass or copies.
+
+constexpr u32 BNSH_MAGIC = 0x48534E42; // BNSH
+constexpr u32 NVN_BYTECODE_MAGIC = 0x12345678;
+constexpr size_t NVN_BYTECODE_HEADER_SIZE = 0x30;
+
+// in the order of the stage code offsets of shader_info_data
+enum class BNSHStage : u32 {
+  Vertex,
+  Hull,
+  Domain,
+  Geometry,
+  Fragment,
+  Compute,
+  Count,
+};
+
+const char* GetBNSHStageName(BNSHStage stage);
+// inverse of GetBNSHStageName
+std::optional<BNSHStage> ParseBNSHStage(std::string_view name);
+
+typedef struct BNSHProgramCode {
+  uint32_t variation;
+  BNSHStage stage;
+  // byte range of the shader program header and instructions inside the file
+  size_t offset;
+  size_t size;
+  // stage reflection data, 0 if the program has none
+  size_t reflectionOffset;
+} BNSHProgramCode;
+
+// named entry of a reflection dictionary with its hardware slot, -1 if the stage doesn't use it.
+// The name points into the string pool of the file data
+typedef struct BNSHResource {
+  std::string_view name;
+  s32 slot;
+} BNSHResource;
+
+// reflection dictionary viewed in place in the file data, entries are resolved on access. The
+// bounds are checked once by ReadBNSHStageReflection
+class BNSHResourceList {
+public:
+  class Iterator {
+  public:
+    Iterator(const BNSHResourceList* list, size_t index) : list{list}, index{index} {}
+
+    BNSHResource operator*() const { return (*list)[index]; }
+    Iterator& operator++() {
+      ++index;
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return index == other.index; }
+    bool operator!=(const Iterator& other) const { return index != other.index; }
+
+  private:
+    const BNSHResourceList* list;
+    size_t index;
+  };
+
+  BNSHResourceList() = default;
+  BNSHResourceList(const u8* data, u64 entries, u64 slots, u32 count)
+    : data{data}, entries{entries}, slots{slots}, count{count} {}
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  BNSHResource operator[](size_t index) const;
+
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, count); }
+
+private:
+  const u8* data = nullptr;
+  // offsets of the first dictionary entry and of the first slot
+  u64 entries = 0;
+  u64 slots = 0;
+  u32 count = 0;
+};
+
+// resources of a stage in dictionary order, views into the file data which must outlive it
+typedef struct BNSHStageReflection {
+  // local workgroup size of compute programs, 0 for other stages
+  std::array<u32, 3> workgroupSize;
+  BNSHResourceList inputs;
+  BNSHResourceList outputs;
+  BNSHResourceList samplers;
+  BNSHResourceList constantBuffers;
+  BNSHResourceList unorderedAccessBuffers;
+  BNSHResourceList images;
+} BNSHStageReflection;
+
+// variations of a bnsh file, read from the header and blocks only so that single programs can be
+// looked up without touching the others
+typedef struct BNSHIndex {
+  // shader file name from the _STR block, empty if the file has none
+  std::string name;
+  u32 variationCount;
+  u64 variationArray;
+} BNSHIndex;
+
+// reads the index of a bnsh file, returns false and describes the problem in error if the file is
+// malformed
+bool ReadBNSHIndex(const u8* data, size_t dataSize, BNSHIndex& index, std::string& error);
+
+// looks up the program of a variation's stage, or its first stage if stage is unset. Only the
+// variation's program data and the bytecode header are read. code is left empty if the variation
+// has no such program
+bool FindBNSHProgramCode(const u8* data, size_t dataSize, const BNSHIndex& index, u32 variation,
+                         std::optional<BNSHStage> stage, std::optional<BNSHProgramCode>& code,
+                         std::string& error);
+
+// follows the container structure to every stage program of every variation, returns false and
+// describes the problem in error if the file is malformed
+bool ReadBNSHProgramCodes(const u8* data, size_t dataSize, std::vector<BNSHProgramCode>& codes,
+                          std::string& error);
+
+// views the resource dictionaries and slots of a program's stage reflection in place, after
+// checking that every entry lies inside the file
+bool ReadBNSHStageReflection(const u8* data, size_t dataSize, const BNSHProgramCode& code,
+                             BNSHStageReflection& reflection, std::string& error);
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "bnsh_cli/bundle.h"
+
+BundleWriter::~BundleWriter() {
+  if (file) fclose(file);
+}
+
+bool BundleWriter::Open(const std::string& bundlePath) {
+  path = bundlePath;
+  file = fopen(path.c_str(), "wb");
+  if (!file) {
+    fprintf(stderr, "%s: Failed to open file for writing!\n", path.c_str());
+    return false;
+  }
+  // the header gets patched in by Finish
+  BundleHeader header{};
+  failed = fwrite(&header, sizeof(header), 1, file) != 1;
+  fileOffset = sizeof(header);
+  return !failed;
+}
+
+bool BundleWriter::WriteAligned(const void* data, size_t size, u64& offset) {
+  static constexpr u8 padding[BUNDLE_ALIGNMENT] = {};
+  const size_t paddingSize = (BUNDLE_ALIGNMENT - fileOffset % BUNDLE_ALIGNMENT) % BUNDLE_ALIGNMENT;
+  if (fwrite(padding, 1, paddingSize, file) != paddingSize ||
+      fwrite(data, 1, size, file) != size) {
+    return false;
+  }
+  offset = fileOffset + paddingSize;
+  fileOffset = offset + size;
+  return true;
+}
+
+bool BundleWriter::Add(const std::string& name, const DecodeOutput& output) {
+  std::lock_guard lock{mutex};
+  if (!file || failed) return false;
+
+  BundleEntry entry{};
+  entry.nameHash = HashBundleName(name);
+  entry.spirvSize = static_cast<u32>(output.spirv.size() * sizeof(u32));
+  entry.jsonSize = static_cast<u32>(output.json.size());
+  entry.nameOffset = static_cast<u32>(names.size());
+  entry.nameSize = static_cast<u32>(name.size());
+  if (!WriteAligned(output.spirv.data(), entry.spirvSize, entry.spirvOffset) ||
+      !WriteAligned(output.json.data(), entry.jsonSize, entry.jsonOffset)) {
+    fprintf(stderr, "%s: Failed to write file!\n", path.c_str());
+    failed = true;
+    return false;
+  }
+  names += name;
+  entries.push_back(entry);
+  return true;
+}
+
+bool BundleWriter::AddShared(const std::string& name, const std::string& sharedName) {
+  std::lock_guard lock{mutex};
+  if (!file || failed) return false;
+
+  BundleEntry entry{};
+  entry.nameHash = HashBundleName(name);
+  entry.nameOffset = static_cast<u32>(names.size());
+  entry.nameSize = static_cast<u32>(name.size());
+  names += name;
+  sharedEntries.emplace_back(entry, sharedName);
+  return true;
+}
+
+bool BundleWriter::Finish() {
+  std::lock_guard lock{mutex};
+  if (!file) return false;
+
+  // point shared entries at the blobs of the entries they share
+  std::unordered_map<std::string_view, const BundleEntry*> entriesByName;
+  for (const BundleEntry& entry : entries) {
+    entriesByName.emplace(std::string_view(names).substr(entry.nameOffset, entry.nameSize), &entry);
+  }
+  std::vector<BundleEntry> resolved;
+  for (auto& [entry, sharedName] : sharedEntries) {
+    const auto shared = entriesByName.find(sharedName);
+    if (shared == entriesByName.end()) {
+      fprintf(stderr, "%s: Missing shared entry %s\n", path.c_str(), sharedName.c_str());
+      failed = true;
+      continue;
+    }
+    entry.spirvOffset = shared->second->spirvOffset;
+    entry.spirvSize = shared->second->spirvSize;
+    entry.jsonOffset = shared->second->jsonOffset;
+    entry.jsonSize = shared->second->jsonSize;
+    resolved.push_back(entry);
+  }
+  entries.insert(entries.end(), resolved.begin(), resolved.end());
+
+  std::sort(entries.begin(), entries.end(), [this](const BundleEntry& a, const BundleEntry& b) {
+    return BundleEntryLess(a, b.nameHash,
+                           std::string_view(names).substr(a.nameOffset, a.nameSize),
+                           std::string_view(names).substr(b.nameOffset, b.nameSize));
+  });
+
+  BundleHeader header{};
+  header.magic = BUNDLE_MAGIC;
+  header.version = BUNDLE_VERSION;
+  header.entryCount = static_cast<u32>(entries.size());
+  bool success = !failed &&
+    WriteAligned(entries.data(), entries.size() * sizeof(BundleEntry), header.indexOffset) &&
+    WriteAligned(names.data(), names.size(), header.namesOffset) &&
+    fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+  success &= fclose(file) == 0;
+  file = nullptr;
+  if (!success) fprintf(stderr, "%s: Failed to write file!\n", path.c_str());
+  return success;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bnsh_cli/bundle_format.h"
+#include "bnsh_cli/decoder.h"
+#include "common/common_types.h"
+
+// streams decode results into a bundle file laid out as described in bundle_format.h, Add may be
+// called from multiple threads
+class BundleWriter {
+public:
+  ~BundleWriter();
+
+  bool Open(const std::string& path);
+  bool Add(const std::string& name, const DecodeOutput& output);
+  // adds an entry sharing the spirv and json of the entry named sharedName, which may still be
+  // added later
+  bool AddShared(const std::string& name, const std::string& sharedName);
+  // writes the index and closes the file
+  bool Finish();
+
+private:
+  bool WriteAligned(const void* data, size_t size, u64& offset);
+
+  std::mutex mutex;
+  FILE* file = nullptr;
+  std::string path;
+  u64 fileOffset = 0;
+  bool failed = false;
+  std::vector<BundleEntry> entries;
+  std::string names;
+  // entries added with AddShared and the names of the entries they share, resolved by Finish
+  std::vector<std::pair<BundleEntry, std::string>> sharedEntries;
+};
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "bnsh_cli/bundle_format.h"
+#include "common/hash.h"
+
+u64 HashBundleName(std::string_view name) {
+  return Common::ComputeHash64(name.data(), name.size());
+}
+
+bool BundleEntryLess(const BundleEntry& entry, u64 nameHash, std::string_view entryName,
+                     std::string_view name) {
+  return entry.nameHash != nameHash ? entry.nameHash < nameHash : entryName < name;
+}
+
+bool IsValidBundle(const u8* data, size_t size) {
+  if (size < sizeof(BundleHeader) || reinterpret_cast<uintptr_t>(data) % alignof(u64) != 0) {
+    return false;
+  }
+  const BundleHeader* header = reinterpret_cast<const BundleHeader*>(data);
+  return header->magic == BUNDLE_MAGIC && header->version == BUNDLE_VERSION &&
+         header->indexOffset % alignof(BundleEntry) == 0 && header->indexOffset <= size &&
+         (size - header->indexOffset) / sizeof(BundleEntry) >= header->entryCount &&
+         header->namesOffset <= size;
+}
+
+const BundleEntry* FindBundleEntry(const u8* data, size_t size, std::string_view name) {
+  if (!IsValidBundle(data, size)) return nullptr;
+  const BundleHeader* header = reinterpret_cast<const BundleHeader*>(data);
+  const BundleEntry* begin = reinterpret_cast<const BundleEntry*>(data + header->indexOffset);
+  const BundleEntry* end = begin + header->entryCount;
+  const std::string_view names(reinterpret_cast<const char*>(data + header->namesOffset),
+                               size - header->namesOffset);
+  const auto entryName = [&names](const BundleEntry& entry) {
+    return entry.nameOffset <= names.size() ? names.substr(entry.nameOffset, entry.nameSize)
+                                            : std::string_view{};
+  };
+
+  const u64 nameHash = HashBundleName(name);
+  const BundleEntry* entry =
+    std::lower_bound(begin, end, name, [&](const BundleEntry& lhs, std::string_view rhs) {
+      return BundleEntryLess(lhs, nameHash, entryName(lhs), rhs);
+    });
+  if (entry == end || entry->nameHash != nameHash || entryName(*entry) != name) return nullptr;
+  // the blobs are handed out as pointers into the bundle
+  const auto contains = [size](u64 offset, u64 length) {
+    return offset <= size && length <= size - offset;
+  };
+  if (!contains(entry->spirvOffset, entry->spirvSize) ||
+      entry->spirvOffset % alignof(u32) != 0 || !contains(entry->jsonOffset, entry->jsonSize)) {
+    return nullptr;
+  }
+  return entry;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "common/common_types.h"
+
+// A bundle packs the decode results of many shaders into a single file which can be memory
+// mapped and queried in place. All fields are little endian.
+//
+//   BundleHeader
+//   blobs                      spirv and json of each shader, BUNDLE_ALIGNMENT aligned, may be
+//                              shared by several entries
+//   BundleEntry[entryCount]    at indexOffset, sorted by (nameHash, name)
+//   names                      at namesOffset, not null terminated
+//
+// A lookup hashes the name with CityHash64, binary searches the index and compares the name of
+// the matching entries. Runtimes can use FindBundleEntry, or bnsh_bundle_find of bnsh.h from C.
+
+constexpr u32 BUNDLE_MAGIC = 0x42534E42; // BNSB
+constexpr u32 BUNDLE_VERSION = 1;
+constexpr u64 BUNDLE_ALIGNMENT = 16;
+
+typedef struct BundleHeader {
+  u32 magic;
+  u32 version;
+  u32 entryCount;
+  u32 reserved;
+  u64 indexOffset;
+  u64 namesOffset;
+} BundleHeader;
+static_assert(sizeof(BundleHeader) == 32);
+
+typedef struct BundleEntry {
+  u64 nameHash;
+  u64 spirvOffset;
+  u64 jsonOffset;
+  u32 spirvSize;
+  u32 jsonSize;
+  u32 nameOffset;
+  u32 nameSize;
+} BundleEntry;
+static_assert(sizeof(BundleEntry) == 40);
+
+u64 HashBundleName(std::string_view name);
+
+// order of the entries in the index
+bool BundleEntryLess(const BundleEntry& entry, u64 nameHash, std::string_view entryName,
+                     std::string_view name);
+
+// returns whether data is a bundle mapped at an 8 byte aligned address, with its index and names
+// within the data
+bool IsValidBundle(const u8* data, size_t size);
+
+// finds an entry in a bundle mapped at an 8 byte aligned address, returns nullptr if it's missing
+// or the bundle is malformed. The blobs of a returned entry lie within the bundle
+const BundleEntry* FindBundleEntry(const u8* data, size_t size, std::string_view name);
@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "bnsh_cli/cache.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr u32 CACHE_MAGIC = 0x43534E42; // BNSC
+
+typedef struct CacheEntryHeader {
+  u32 magic;
+  u32 spirvSize;
+  u32 jsonSize;
+  u32 reserved;
+} CacheEntryHeader;
+
+}  // namespace
+
+DecodeCache::DecodeCache(std::string directory) : directory{std::move(directory)} {}
+
+std::string DecodeCache::GetEntryPath(u64 key) const {
+  // shard by the leading byte to keep directories small on large corpora
+  return fmt::format("{}/{:02x}/{:016x}.bin", directory, key >> 56, key);
+}
+
+std::optional<DecodeOutput> DecodeCache::Load(u64 key) const {
+  FILE* pFile = fopen(GetEntryPath(key).c_str(), "rb");
+  if (!pFile) return std::nullopt;
+
+  DecodeOutput output{};
+  CacheEntryHeader header{};
+  bool success = fread(&header, sizeof(header), 1, pFile) == 1 && header.magic == CACHE_MAGIC &&
+                 header.spirvSize % sizeof(u32) == 0;
+  if (success) {
+    output.spirv.resize(header.spirvSize / sizeof(u32));
+    output.json.resize(header.jsonSize);
+    success = fread(output.spirv.data(), 1, header.spirvSize, pFile) == header.spirvSize &&
+              fread(output.json.data(), 1, header.jsonSize, pFile) == header.jsonSize;
+  }
+  fclose(pFile);
+
+  // treat damaged entries as misses, they get rewritten by the next store
+  if (!success) return std::nullopt;
+  return output;
+}
+
+void DecodeCache::Store(u64 key, const DecodeOutput& output) const {
+  const fs::path path = GetEntryPath(key);
+  std::error_code ec;
+  fs::create_directories(path.parent_path(), ec);
+
+  // write to a private file first, readers never observe partial entries
+  const size_t unique = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                        static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  const fs::path tmpPath = path.string() + fmt::format(".{:x}.tmp", unique);
+
+  CacheEntryHeader header{};
+  header.magic = CACHE_MAGIC;
+  header.spirvSize = static_cast<u32>(output.spirv.size() * sizeof(u32));
+  header.jsonSize = static_cast<u32>(output.json.size());
+
+  FILE* pFile = fopen(tmpPath.string().c_str(), "wb");
+  if (!pFile) return;
+  bool success = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+                 fwrite(output.spirv.data(), 1, header.spirvSize, pFile) == header.spirvSize &&
+                 fwrite(output.json.data(), 1, header.jsonSize, pFile) == header.jsonSize;
+  success &= fclose(pFile) == 0;
+
+  if (success) fs::rename(tmpPath, path, ec);
+  if (!success || ec) fs::remove(tmpPath, ec);
+}
+
+std::vector<DecodeOutput> DecodeShaderVariantsCached(const DecodeCache* cache,
+                                                     VideoCommon::Shader::ProgramCodeView code,
+                                                     const std::vector<DecodeVariant>& variants,
+                                                     const BNSHStageReflection* reflection,
+                                                     ShaderStats* stats) {
+  std::vector<DecodeOutput> outputs(variants.size());
+  if (stats) {
+    stats->bytecodeInstructions = static_cast<u32>(code.size());
+    stats->variants = static_cast<u32>(variants.size());
+  }
+  std::vector<u64> keys(variants.size());
+  std::vector<DecodeVariant> misses;
+  std::vector<size_t> missIndices;
+  for (size_t ii = 0; ii < variants.size(); ++ii) {
+    if (cache) {
+      keys[ii] = ComputeDecodeKey(code, variants[ii], reflection);
+      if (std::optional<DecodeOutput> output = cache->Load(keys[ii])) {
+        outputs[ii] = std::move(*output);
+        continue;
+      }
+    }
+    misses.push_back(variants[ii]);
+    missIndices.push_back(ii);
+  }
+  if (stats) stats->cachedVariants = static_cast<u32>(variants.size() - misses.size());
+  if (misses.empty()) return outputs;
+
+  std::vector<SPIRVData> results = DecodeShaderVariants(code, misses, reflection, stats ? &stats->decode : nullptr);
+  for (size_t ii = 0; ii < results.size(); ++ii) {
+    DecodeOutput& output = outputs[missIndices[ii]];
+    const auto jsonStart = std::chrono::steady_clock::now();
+    output.json = GenerateJSON(results[ii]);
+    if (stats) stats->json += std::chrono::steady_clock::now() - jsonStart;
+    output.spirv = std::move(results[ii].spirv);
+    if (cache) cache->Store(keys[missIndices[ii]], output);
+  }
+  return outputs;
+}
+
+std::pair<std::vector<DecodeOutput>, std::vector<DecodeOutput>> DecodeLinkedShaderVariantsCached(
+  const DecodeCache* cache, const LinkedStage& vertex, const LinkedStage& fragment,
+  const std::vector<DecodeVariant>& variants) {
+  std::pair<std::vector<DecodeOutput>, std::vector<DecodeOutput>> outputs;
+  std::vector<u64> vertexKeys(variants.size());
+  std::vector<u64> fragmentKeys(variants.size());
+  if (cache) {
+    for (size_t ii = 0; ii < variants.size(); ++ii) {
+      vertexKeys[ii] = ComputeDecodeKey(vertex.code, variants[ii], vertex.reflection, fragment.code);
+      fragmentKeys[ii] = ComputeDecodeKey(fragment.code, variants[ii], fragment.reflection, vertex.code);
+    }
+    for (size_t ii = 0; ii < variants.size(); ++ii) {
+      std::optional<DecodeOutput> vertexOutput = cache->Load(vertexKeys[ii]);
+      std::optional<DecodeOutput> fragmentOutput = cache->Load(fragmentKeys[ii]);
+      if (!vertexOutput || !fragmentOutput) break;
+      outputs.first.push_back(std::move(*vertexOutput));
+      outputs.second.push_back(std::move(*fragmentOutput));
+    }
+    if (outputs.first.size() == variants.size()) return outputs;
+  }
+
+  auto [vertexResults, fragmentResults] = DecodeLinkedShaderVariants(vertex, fragment, variants);
+  const auto toOutputs = [&](std::vector<SPIRVData>& results, const std::vector<u64>& keys) {
+    std::vector<DecodeOutput> out(results.size());
+    for (size_t ii = 0; ii < results.size(); ++ii) {
+      out[ii].json = GenerateJSON(results[ii]);
+      out[ii].spirv = std::move(results[ii].spirv);
+      if (cache) cache->Store(keys[ii], out[ii]);
+    }
+    return out;
+  };
+  outputs.first = toOutputs(vertexResults, vertexKeys);
+  outputs.second = toOutputs(fragmentResults, fragmentKeys);
+  return outputs;
+}
+
+DecodeOutput DecodeShaderCached(const DecodeCache* cache,
+                                VideoCommon::Shader::ProgramCodeView code,
+                                uint8_t base_binding_index,
+                                const std::vector<u8>& input_varyings,
+                                const BNSHStageReflection* reflection) {
+  DecodeVariant variant{};
+  variant.base_binding_index = base_binding_index;
+  variant.input_varyings = input_varyings;
+  return std::move(DecodeShaderVariantsCached(cache, code, { variant }, reflection)[0]);
+}
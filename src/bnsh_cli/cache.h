@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bnsh_cli/decoder.h"
+#include "common/common_types.h"
+
+// Content addressed on-disk store of decode results, keyed by ComputeDecodeKey. Entries are
+// published with an atomic rename, so concurrent workers and processes can share a directory.
+class DecodeCache {
+public:
+  explicit DecodeCache(std::string directory);
+
+  std::optional<DecodeOutput> Load(u64 key) const;
+  void Store(u64 key, const DecodeOutput& output) const;
+
+private:
+  std::string GetEntryPath(u64 key) const;
+
+  std::string directory;
+};
+
+// decodes every variant of a shader with a single ir build, variants found in the cache are
+// not decoded again
+std::vector<DecodeOutput> DecodeShaderVariantsCached(const DecodeCache* cache,
+                                                     VideoCommon::Shader::ProgramCodeView code,
+                                                     const std::vector<DecodeVariant>& variants,
+                                                     const BNSHStageReflection* reflection = nullptr,
+                                                     ShaderStats* stats = nullptr);
+
+// linked decode of the vertex and fragment program of a variation, the pair is only decoded if
+// any of its variants is missing from the cache
+std::pair<std::vector<DecodeOutput>, std::vector<DecodeOutput>> DecodeLinkedShaderVariantsCached(
+  const DecodeCache* cache, const LinkedStage& vertex, const LinkedStage& fragment,
+  const std::vector<DecodeVariant>& variants);
+
+// decodes a shader, or returns the stored result of an earlier decode if a cache is passed
+DecodeOutput DecodeShaderCached(const DecodeCache* cache,
+                                VideoCommon::Shader::ProgramCodeView code,
+                                uint8_t base_binding_index,
+                                const std::vector<u8>& input_varyings,
+                                const BNSHStageReflection* reflection = nullptr);
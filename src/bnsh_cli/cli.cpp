@@ -1,235 +1,26 @@
 #define _CRT_SECURE_NO_WARNINGS
 
-#include <algorithm>
-#include <cstddef>
-#include <fstream>
-#include <iostream>
-#include <memory>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "bnsh_cli/batch.h"
+#include "bnsh_cli/bundle.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/decoder.h"
+#include "bnsh_cli/programs.h"
+#include "bnsh_cli/server.h"
+#include "bnsh_cli/stream.h"
 #include "common/common_types.h"
-#include "video_core/engines/maxwell_3d.h"
-#include "video_core/shader/shader_ir.h"
-#include "video_core/shader/spirv_decompiler.h"
 
 #ifdef EMSCRIPTEN
 #include <emscripten.h>
 #endif
 
-namespace {
-
-using Tegra::Engines::ShaderType;
-using Tegra::Shader::Attribute;
-
-using VideoCommon::Shader::CompileDepth;
-using VideoCommon::Shader::CompilerSettings;
-using VideoCommon::Shader::ConstBuffer;
-using VideoCommon::Shader::DeviceSettings;
-using VideoCommon::Shader::GlobalMemoryBase;
-using VideoCommon::Shader::GlobalMemoryUsage;
-using VideoCommon::Shader::ProgramCode;
-using VideoCommon::Shader::Registry;
-using VideoCommon::Shader::Sampler;
-using VideoCommon::Shader::SerializedRegistryInfo;
-using VideoCommon::Shader::ShaderIR;
-using VideoCommon::Shader::Specialization;
-
-using Maxwell = Tegra::Engines::Maxwell3D::Regs;
-
-typedef enum : u32 {
-  Compute,
-  Vertex,
-  TesselationControl,
-  TesselationEvaluation,
-  Geometry,
-  Fragment
-} ShaderStage;
-
-typedef struct CommonWord0 {
-  uint32_t SphType : 5;
-  uint32_t Version : 5;
-  ShaderStage Stage : 4;
-  bool MrtEnable : 1;
-  bool KillsPixels : 1;
-  bool DoesGlobalStore : 1;
-  uint32_t SassVersion : 4;
-  uint32_t Reserved : 5;
-  bool DoesLoadOrStore : 1;
-  bool DoesFp64 : 1;
-  uint32_t StreamOutMask : 4;
-} CommonWord0;
-
-typedef struct SPIRVData {
-  std::vector<u32> spirv;
-  std::list<Sampler> samplers;
-  std::map<u32, ConstBuffer> constant_buffers;
-  std::set<Attribute::Index> input_attributes;
-  std::set<Attribute::Index> output_attributes;
-} SPIRVData;
-
-ShaderType ConvertSPHStageToYuzuStage(ShaderStage stage) {
-  switch (stage) {
-    case ShaderStage::Compute:
-      return ShaderType::Compute;
-    case ShaderStage::Vertex:
-      return ShaderType::Vertex;
-    case ShaderStage::TesselationControl:
-      return ShaderType::TesselationControl;
-    case ShaderStage::TesselationEvaluation:
-      return ShaderType::TesselationEval;
-    case ShaderStage::Geometry:
-      return ShaderType::Geometry;
-    case ShaderStage::Fragment:
-      return ShaderType::Fragment;
-  };
-  return ShaderType::Compute;
-}
-
-Specialization GetSpecialization(uint32_t baseBindingIndex,
-                                 std::vector<u8> customInputVaryings) {
-  Specialization specialization{};
-  specialization.base_binding = baseBindingIndex;
-  specialization.custom_input_varyings = customInputVaryings;
-  specialization.ndc_minus_one_to_one = true;
-  specialization.point_size = 1.0f;
-  specialization.shared_memory_size = 0;
-  for (std::size_t i = 0; i < Maxwell::NumVertexAttributes; ++i) {
-    specialization.enabled_attributes[i] = true;
-    specialization.attribute_types[i] = Maxwell::VertexAttribute::Type::Float;
-  }
-  return specialization;
-}
-
-DeviceSettings GetDeviceSettings() {
-  DeviceSettings device_settings{};
-  device_settings.IsFloat16Supported = false;
-  device_settings.IsWarpSizePotentiallyBiggerThanGuest = true;
-  device_settings.IsFormatlessImageLoadSupported = true;
-  device_settings.IsNvViewportSwizzleSupported = false;
-  device_settings.IsKhrUniformBufferStandardLayoutSupported = false;
-  device_settings.IsExtIndexTypeUint8Supported = false;
-  device_settings.IsExtDepthRangeUnrestrictedSupported = true;
-  device_settings.IsExtShaderViewportIndexLayerSupported = true;
-  device_settings.IsExtTransformFeedbackSupported = false;
-  device_settings.IsExtCustomBorderColorSupported = false;
-  device_settings.IsExtExtendedDynamicStateSupported = false;
-  return device_settings;
-}
-
-std::string GenerateJSON(SPIRVData& spirv_data) {
-  std::string json = "";
-  json += "{";
-  // write spirv length
-  {
-    json += "\"spirvLength\":";
-    json += std::to_string(spirv_data.spirv.size());
-  }
-  json += ",";
-  // write constantBuffers
-  {
-    json += "\"constantBuffers\":[";
-    uint32_t counter = 0;
-    for (const auto& [index, size] : spirv_data.constant_buffers) {
-      json += "{";
-      json += "\"index\":";
-      json += std::to_string(index);
-      json += ",";
-      json += "\"maxOffset\":";
-      json += std::to_string(size.GetMaxOffset());
-      json += ",";
-      json += "\"size\":";
-      json += std::to_string(size.GetSize());
-      json += "}";
-      if (counter++ < spirv_data.constant_buffers.size() - 1) json += ",";
-    }
-    json += "]";
-  }
-  json += ",";
-  // write samplers
-  {
-    json += "\"samplers\":[";
-    uint32_t counter = 0;
-    for (const auto& sampler : spirv_data.samplers) {
-      json += "{";
-      json += "\"index\":";
-      json += std::to_string(sampler.index);
-      json += ",";
-      json += "\"offset\":";
-      json += std::to_string(sampler.offset);
-      json += ",";
-      json += "\"isShadow\":";
-      json += std::to_string(sampler.is_shadow);
-      json += "}";
-      if (counter++ < spirv_data.samplers.size() - 1) json += ",";
-    }
-    json += "]";
-  }
-  json += ",";
-  // input attributes
-  {
-    json += "\"inputAttributes\":[";
-    uint32_t counter = 0;
-    for (const auto& attr : spirv_data.input_attributes) {
-      json += std::to_string(static_cast<u64>(attr));
-      if (counter++ < spirv_data.input_attributes.size() - 1) json += ",";
-    }
-    json += "]";
-  }
-  json += ",";
-  // output attributes
-  {
-    json += "\"outputAttributes\":[";
-    uint32_t counter = 0;
-    for (const auto& attr : spirv_data.output_attributes) {
-      json += std::to_string(static_cast<u64>(attr));
-      if (counter++ < spirv_data.output_attributes.size() - 1) json += ",";
-    }
-    json += "]";
-  }
-  json += "}";
-  json += "\0";
-  return json;
-}
-
-}  // namespace
-
-SPIRVData DecodeShader(
-  uint32_t len_raw_data, u64* raw_data,
-  uint8_t base_binding_index,
-  uint32_t len_raw_input_varyings, uint8_t* raw_input_varyings
-) {
-  ProgramCode code(raw_data, raw_data + len_raw_data / sizeof(u64));
-
-  std::vector<uint8_t> input_varyings(raw_input_varyings, raw_input_varyings + len_raw_input_varyings);
-
-  // extract shader stage
-  CommonWord0 common_word_0 = reinterpret_cast<CommonWord0*>(code.data())[0];
-  ShaderType stage = ConvertSPHStageToYuzuStage(common_word_0.Stage);
-
-  struct SerializedRegistryInfo registry_info;
-  Registry registry(stage, registry_info);
-
-  CompilerSettings settings{ CompileDepth::FullDecompile };
-
-  ShaderIR shader_ir(code, 10, settings, registry);
-
-  Specialization specialization =
-    GetSpecialization(base_binding_index, input_varyings);
-
-  DeviceSettings device_settings = GetDeviceSettings();
-
-  std::vector<u32> spirv = VideoCommon::Shader::Decompile(
-    device_settings, shader_ir, stage, registry, specialization);
-
-  SPIRVData out_data{};
-  out_data.spirv = spirv;
-  out_data.samplers = shader_ir.GetSamplers();
-  out_data.constant_buffers = shader_ir.GetConstantBuffers();
-  out_data.input_attributes = shader_ir.GetInputAttributes();
-  out_data.output_attributes = shader_ir.GetOutputAttributes();
-
-  return out_data;
-}
+using VideoCommon::Shader::ProgramCodeView;
 
 #ifdef EMSCRIPTEN
 extern "C" {
@@ -241,13 +32,13 @@ extern "C" {
     u32* spirv_out,
     char* json_out
   ) {
-    SPIRVData spirv_out = DecodeShader(len_raw_data, raw_data, base_binding_index, len_raw_input_varyings, raw_input_varyings);
+    SPIRVData data = DecodeShader(len_raw_data, raw_data, base_binding_index, len_raw_input_varyings, raw_input_varyings);
 
     // copy spirv data to outer world
-    memcpy(&spirv_out[0], spirv.data(), spirv.size() * sizeof(spirv[0]));
+    memcpy(spirv_out, data.spirv.data(), data.spirv.size() * sizeof(data.spirv[0]));
 
     // copy json data to outer world
-    std::string json = GenerateJSON(out_data);
+    std::string json = GenerateJSON(data);
     strncpy(json_out, json.c_str(), json.size());
   }
 
@@ -262,64 +53,70 @@ void PrintUsage() {
           "  -o, --output-json     Output JSON file.\n"
           "  -o, --output-spirv    Output SPIR-V file.\n"
           "Additional Options:\n"
-          "  --base-binding-index  Base binding index.\n"
-          "  --input-varyings      Specify custom input varyings.\n");
+          "  --base-binding-index  Base binding index, repeat to emit several variants.\n"
+          "  --input-varyings      Specify custom input varyings, repeat to emit several variants.\n"
+          "  --cache-dir           Reuse decode results stored in this directory.\n"
+          "  --stats               Write per phase decode timings as JSON to this file.\n"
+          "  --variation           Decode the program of this BNSH variation, reading only its data.\n"
+          "  --stage               With --variation, the stage to decode (vertex, fragment, ...).\n"
+          "  --all-programs        Decode every variation and stage of the input in parallel.\n"
+          "  --resolve-bindings    Bind resources in the order of the BNSH reflection.\n"
+          "  --link-varyings       With --all-programs, prune varyings unused by the other stage.\n"
+          "  --dedup               Decode identical programs once, duplicates reference its SPIR-V.\n"
+          "Batch Options:\n"
+          "  --batch               Decode every shader in a directory or a manifest file.\n"
+          "  --output-dir          Output directory, defaults to next to each input.\n"
+          "  --output-bundle       Pack all outputs into a single bundle file.\n"
+          "  -j, --jobs            Number of worker threads.\n"
+          "  --stream              Decode every program of a dump of concatenated BNSH files and\n"
+          "                        bytecode sections into --output-dir, reading it in a window.\n"
+          "  --stream-window       Window size of --stream in MiB, bounds the size of an item.\n"
+          "Server Options:\n"
+          "  --serve-stdio         Serve length-prefixed decode requests over stdin/stdout.\n"
+          "  --listen              Serve decode requests on a unix domain socket path.\n"
+          "  --queue-size          Maximum number of queued socket requests.\n"
+          "  --max-connections     Maximum number of connected socket clients.\n");
 }
 
-ProgramCode LoadFileProgramCode(std::string& fileName) {
-  std::ifstream file(fileName, std::ios::ate | std::ios::binary);
-  if (!file.is_open()) {
-    fprintf(stderr, "Failed to open file!\n");
-    std::exit(EXIT_FAILURE);
-  }
-
-  size_t fileSize = (size_t)file.tellg();
-
-  size_t bufferSize = (fileSize + sizeof(u64) - 1) / sizeof(u64);
-  ProgramCode buffer(bufferSize);
-
-  file.seekg(0);
-  file.read(reinterpret_cast<char*>(buffer.data()), fileSize);
-  file.close();
-
-  u32 magic = reinterpret_cast<u32*>(buffer.data())[0];
-
-  ProgramCode out;
-
-  // bnsh file, find bytecode section
-  if (magic == 0x48534E42) {
-    fprintf(stdout, "Detected BNSH file\n");
-    u32* dataU32 = reinterpret_cast<u32*>(buffer.data());
-    u32 dataU32Len = (fileSize + sizeof(u32) - 1) / sizeof(u32);
-    u32 byteCodeOffset = 0x0;
-    for (int ii = 0; ii < dataU32Len; ++ii) {
-      if (dataU32[ii] == 0x12345678) {
-        // found bytecode section
-        if (byteCodeOffset != 0x0) {
-          fprintf(stdout, "Multiple BNSH bytecode sections aren't supported, falling back to first detected BNSH bytecode code section\n");
-          break;
-        }
-        byteCodeOffset = ii * sizeof(u32) + 0x30;
-      }
+// one variant per combination of the passed base binding indices and input varying sets
+std::vector<DecodeVariant> MakeDecodeVariants(std::vector<uint8_t> baseBindingIndices,
+                                              std::vector<std::vector<u8>> inputVaryingSets,
+                                              bool resolveBindings) {
+  if (baseBindingIndices.empty()) baseBindingIndices.push_back(0);
+  if (inputVaryingSets.empty()) inputVaryingSets.emplace_back();
+
+  std::vector<DecodeVariant> variants;
+  for (uint8_t baseBindingIndex : baseBindingIndices) {
+    for (size_t ii = 0; ii < inputVaryingSets.size(); ++ii) {
+      DecodeVariant& variant = variants.emplace_back();
+      variant.base_binding_index = baseBindingIndex;
+      variant.input_varyings = inputVaryingSets[ii];
+      variant.resolve_bindings = resolveBindings;
+      // only name the settings that actually vary
+      if (baseBindingIndices.size() > 1) variant.suffix += ".b" + std::to_string(baseBindingIndex);
+      if (inputVaryingSets.size() > 1) variant.suffix += ".v" + std::to_string(ii);
     }
-    if (byteCodeOffset == 0x0) {
-      fprintf(stderr, "Missing BNSH bytecode section\n");
-      std::exit(EXIT_FAILURE);
-    }
-    u32 programCodeOffset = byteCodeOffset / sizeof(u64);
-    fprintf(stdout, "Found BNSH bytecode at 0x%X\n", byteCodeOffset);
-    out = ProgramCode(buffer.begin() + programCodeOffset, buffer.end());
   }
-  // got directly fed the binary section
-  else if (magic == 0x12345678) {
-    out = buffer;
+  return variants;
+}
+
+// parses the numeric value of an option, prints a usage error if it isn't a number between min
+// and max
+bool ParseNumberOption(const std::string& name, const std::string& value, long long min,
+                       long long max, uint32_t& result) {
+  size_t end = 0;
+  long long number = 0;
+  try {
+    number = std::stoll(value, &end, 0);
+  } catch (const std::logic_error&) {
+    end = 0;
   }
-  else {
-    fprintf(stderr, "Unsupported data\n");
-    std::exit(EXIT_FAILURE);
+  if (end == 0 || end != value.size() || number < min || number > max) {
+    fprintf(stderr, "%s must be a number between %lld and %lld\n", name.c_str(), min, max);
+    return false;
   }
-
-  return out;
+  result = static_cast<uint32_t>(number);
+  return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -327,8 +124,26 @@ int main(int argc, char* argv[]) {
   std::string inputName;
   std::string outputJSONName;
   std::string outputSPIRVName;
-  uint32_t baseBindingIndex = 0;
-  std::vector<u8> customInputVaryings{};
+  std::vector<uint8_t> baseBindingIndices{};
+  std::vector<std::vector<u8>> inputVaryingSets{};
+  std::string batchName;
+  std::string outputBundleName;
+  std::string outputDirName;
+  uint32_t jobs = 0;
+  bool serveStdio = false;
+  std::string listenPath;
+  uint32_t queueSize = 0;
+  uint32_t maxConnections = 0;
+  std::string cacheDirName;
+  std::string statsName;
+  bool allPrograms = false;
+  bool resolveBindings = false;
+  bool linkVaryings = false;
+  bool dedup = false;
+  std::string streamName;
+  uint32_t streamWindow = 0;
+  std::optional<ProgramSelection> selection;
+  std::string stageName;
 
   std::vector<std::string> args(argv + 1, argv + argc);
   for (auto arg = args.begin(); arg != args.end(); ++arg) {
@@ -346,7 +161,70 @@ int main(int argc, char* argv[]) {
       outputSPIRVName = *(arg + 1);
     }
     else if (*arg == "--base-binding-index") {
-      baseBindingIndex = std::stoi(*(arg + 1), nullptr, 0);
+      // bindings are emitted as u8, a larger base would silently wrap around
+      uint32_t baseBindingIndex = 0;
+      if (!ParseNumberOption(*arg, *(arg + 1), 0, UINT8_MAX, baseBindingIndex)) {
+        return EXIT_FAILURE;
+      }
+      baseBindingIndices.push_back(static_cast<uint8_t>(baseBindingIndex));
+    }
+    else if (*arg == "--serve-stdio") {
+      serveStdio = true;
+    }
+    else if (*arg == "--listen") {
+      listenPath = *(arg + 1);
+    }
+    else if (*arg == "--queue-size") {
+      if (!ParseNumberOption(*arg, *(arg + 1), 1, UINT32_MAX, queueSize)) return EXIT_FAILURE;
+    }
+    else if (*arg == "--max-connections") {
+      if (!ParseNumberOption(*arg, *(arg + 1), 1, UINT32_MAX, maxConnections)) return EXIT_FAILURE;
+    }
+    else if (*arg == "--all-programs") {
+      allPrograms = true;
+    }
+    else if (*arg == "--link-varyings") {
+      linkVaryings = true;
+    }
+    else if (*arg == "--stream") {
+      streamName = *(arg + 1);
+    }
+    else if (*arg == "--stream-window") {
+      // the size of a bnsh file is a u32, a larger window buys nothing
+      if (!ParseNumberOption(*arg, *(arg + 1), 1, 4096, streamWindow)) return EXIT_FAILURE;
+    }
+    else if (*arg == "--variation") {
+      if (!selection) selection.emplace();
+      if (!ParseNumberOption(*arg, *(arg + 1), 0, UINT32_MAX, selection->variation)) {
+        return EXIT_FAILURE;
+      }
+    }
+    else if (*arg == "--stage") {
+      stageName = *(arg + 1);
+    }
+    else if (*arg == "--dedup") {
+      dedup = true;
+    }
+    else if (*arg == "--resolve-bindings") {
+      resolveBindings = true;
+    }
+    else if (*arg == "--stats") {
+      statsName = *(arg + 1);
+    }
+    else if (*arg == "--cache-dir") {
+      cacheDirName = *(arg + 1);
+    }
+    else if (*arg == "--batch") {
+      batchName = *(arg + 1);
+    }
+    else if (*arg == "--output-bundle") {
+      outputBundleName = *(arg + 1);
+    }
+    else if (*arg == "--output-dir") {
+      outputDirName = *(arg + 1);
+    }
+    else if (*arg == "-j" || *arg == "--jobs") {
+      if (!ParseNumberOption(*arg, *(arg + 1), 1, 1024, jobs)) return EXIT_FAILURE;
     }
     else if (*arg == "--input-varyings") {
       std::string arr = (*(arg + 1));
@@ -355,6 +233,7 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
       }
       // extract varying locations
+      std::vector<u8>& customInputVaryings = inputVaryingSets.emplace_back();
       char num_buf[8] = {};
       u8 buf_index = 0;
       for (u8 ii = 1; ii < arr.size(); ++ii) {
@@ -371,37 +250,125 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  std::optional<DecodeCache> cache;
+  if (cacheDirName.size()) cache.emplace(cacheDirName);
+
+  if (serveStdio) {
+    return RunStdioServer(cache ? &*cache : nullptr);
+  }
+
+  if (listenPath.size()) {
+    SocketServerOptions options{};
+    options.path = listenPath;
+    options.jobs = jobs;
+    options.queueSize = queueSize;
+    options.maxConnections = maxConnections;
+    options.cache = cache ? &*cache : nullptr;
+    return RunSocketServer(options);
+  }
+
+  if (streamName.size()) {
+    if (!outputDirName.size()) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+    StreamOptions options{};
+    options.input = streamName;
+    options.outputDir = outputDirName;
+    if (streamWindow) options.windowSize = static_cast<size_t>(streamWindow) * 1024 * 1024;
+    options.variants = MakeDecodeVariants(baseBindingIndices, inputVaryingSets, resolveBindings);
+    options.cache = cache ? &*cache : nullptr;
+    return RunStream(options);
+  }
+
+  if (batchName.size()) {
+    BatchOptions options{};
+    options.input = batchName;
+    options.outputDir = outputDirName;
+    options.jobs = jobs;
+    options.variants = MakeDecodeVariants(baseBindingIndices, inputVaryingSets, resolveBindings);
+    options.statsFile = statsName;
+    options.dedup = dedup;
+    options.cache = cache ? &*cache : nullptr;
+    BundleWriter bundle;
+    if (outputBundleName.size()) {
+      if (!bundle.Open(outputBundleName)) return EXIT_FAILURE;
+      options.bundle = &bundle;
+    }
+    return RunBatch(options);
+  }
+
   if (!inputName.size() || (!outputJSONName.size() && !outputSPIRVName.size())) {
     PrintUsage();
     return EXIT_FAILURE;
   }
 
 
+  if (allPrograms) {
+    ProgramsOptions options{};
+    options.input = inputName;
+    options.outputJSON = outputJSONName;
+    options.outputSPIRV = outputSPIRVName;
+    options.jobs = jobs;
+    options.variants = MakeDecodeVariants(baseBindingIndices, inputVaryingSets, resolveBindings);
+    options.linkVaryings = linkVaryings;
+    options.dedup = dedup;
+    options.cache = cache ? &*cache : nullptr;
+    return RunAllPrograms(options);
+  }
+
   if (inputName.size()) {
-    ProgramCode code = LoadFileProgramCode(inputName);
+    ShaderStats stats{};
+    stats.name = inputName;
+    const auto extractStart = std::chrono::steady_clock::now();
+    if (stageName.size()) {
+      if (!selection) selection.emplace();
+      selection->stage = ParseBNSHStage(stageName);
+      if (!selection->stage) {
+        fprintf(stderr, "Unknown stage %s\n", stageName.c_str());
+        return EXIT_FAILURE;
+      }
+    }
+    std::optional<ProgramSource> source =
+      LoadFileProgramCode(inputName, true, selection ? &*selection : nullptr);
+    if (!source) return EXIT_FAILURE;
+    ProgramCodeView code = source->Code();
+    stats.extract = std::chrono::steady_clock::now() - extractStart;
+
+    if (resolveBindings && !source->reflection) {
+      fprintf(stdout, "Missing BNSH reflection, binding resources sequentially\n");
+    }
 
-    SPIRVData result = DecodeShader(
-      code.size() * sizeof(u64), code.data(),
-      baseBindingIndex,
-      customInputVaryings.size(), customInputVaryings.data()
+    const std::vector<DecodeVariant> variants = MakeDecodeVariants(baseBindingIndices, inputVaryingSets, resolveBindings);
+    std::vector<DecodeOutput> results = DecodeShaderVariantsCached(
+      cache ? &*cache : nullptr, code,
+      variants,
+      source->reflection ? &*source->reflection : nullptr,
+      statsName.size() ? &stats : nullptr
     );
 
-    if (outputJSONName.size()) {
-      // generate json
-      std::string json = GenerateJSON(result);
-      // save json
-      FILE* pFile;
-      pFile = fopen(outputJSONName.c_str(), "w+b");
-      fwrite(json.data(), json.size(), sizeof(char), pFile);
-      fclose(pFile);
+    for (size_t ii = 0; ii < results.size(); ++ii) {
+      const DecodeOutput& result = results[ii];
+
+      if (outputJSONName.size()) {
+        // save json
+        const std::string fileName = InsertFileNameSuffix(outputJSONName, variants[ii].suffix);
+        if (!WriteOutputFile(fileName, result.json.data(), result.json.size())) return EXIT_FAILURE;
+      }
+
+      if (outputSPIRVName.size()) {
+        // save spirv
+        const std::string fileName = InsertFileNameSuffix(outputSPIRVName, variants[ii].suffix);
+        if (!WriteOutputFile(fileName, result.spirv.data(), result.spirv.size() * sizeof(u32))) {
+          return EXIT_FAILURE;
+        }
+      }
     }
 
-    if (outputSPIRVName.size()) {
-      // save spirv
-      FILE* pFile;
-      pFile = fopen(outputSPIRVName.c_str(), "w+b");
-      fwrite(result.spirv.data(), result.spirv.size(), sizeof(u32), pFile);
-      fclose(pFile);
+    if (statsName.size()) {
+      stats.success = true;
+      const std::string json = GenerateStatsJSON({ stats });
+      if (!WriteOutputFile(statsName, json.data(), json.size())) return EXIT_FAILURE;
     }
 
     fprintf(stdout, "Successfully decoded\n");
@@ -0,0 +1,826 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bnsh_cli/bnsh_file.h"
+#include "bnsh_cli/decoder.h"
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "common/word_scan.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/shader/shader_ir.h"
+#include "video_core/shader/spirv_decompiler.h"
+
+namespace {
+
+using Tegra::Engines::ShaderType;
+using Tegra::Shader::Attribute;
+
+using VideoCommon::Shader::CompileDepth;
+using VideoCommon::Shader::CompilerSettings;
+using VideoCommon::Shader::ConstBuffer;
+using VideoCommon::Shader::DeviceSettings;
+using VideoCommon::Shader::GlobalMemoryBase;
+using VideoCommon::Shader::GlobalMemoryUsage;
+using VideoCommon::Shader::ProgramCode;
+using VideoCommon::Shader::ProgramCodeView;
+using VideoCommon::Shader::Registry;
+using VideoCommon::Shader::Sampler;
+using VideoCommon::Shader::SerializedRegistryInfo;
+using VideoCommon::Shader::ShaderIR;
+using VideoCommon::Shader::Specialization;
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+typedef enum : u32 {
+  Compute,
+  Vertex,
+  TesselationControl,
+  TesselationEvaluation,
+  Geometry,
+  Fragment
+} ShaderStage;
+
+typedef struct CommonWord0 {
+  uint32_t SphType : 5;
+  uint32_t Version : 5;
+  ShaderStage Stage : 4;
+  bool MrtEnable : 1;
+  bool KillsPixels : 1;
+  bool DoesGlobalStore : 1;
+  uint32_t SassVersion : 4;
+  uint32_t Reserved : 5;
+  bool DoesLoadOrStore : 1;
+  bool DoesFp64 : 1;
+  uint32_t StreamOutMask : 4;
+} CommonWord0;
+
+ShaderType ConvertSPHStageToYuzuStage(ShaderStage stage) {
+  switch (stage) {
+    case ShaderStage::Compute:
+      return ShaderType::Compute;
+    case ShaderStage::Vertex:
+      return ShaderType::Vertex;
+    case ShaderStage::TesselationControl:
+      return ShaderType::TesselationControl;
+    case ShaderStage::TesselationEvaluation:
+      return ShaderType::TesselationEval;
+    case ShaderStage::Geometry:
+      return ShaderType::Geometry;
+    case ShaderStage::Fragment:
+      return ShaderType::Fragment;
+  };
+  return ShaderType::Compute;
+}
+
+Specialization GetSpecialization(uint32_t baseBindingIndex,
+                                 std::vector<u8> customInputVaryings) {
+  Specialization specialization{};
+  specialization.base_binding = baseBindingIndex;
+  specialization.custom_input_varyings = customInputVaryings;
+  specialization.ndc_minus_one_to_one = true;
+  specialization.point_size = 1.0f;
+  for (std::size_t i = 0; i < Maxwell::NumVertexAttributes; ++i) {
+    specialization.enabled_attributes[i] = true;
+    specialization.attribute_types[i] = Maxwell::VertexAttribute::Type::Float;
+  }
+  return specialization;
+}
+
+ShaderType GetShaderStage(ProgramCodeView code) {
+  CommonWord0 common_word_0 = reinterpret_cast<const CommonWord0*>(code.data())[0];
+  return ConvertSPHStageToYuzuStage(common_word_0.Stage);
+}
+
+CompilerSettings GetCompilerSettings(VideoCommon::Shader::DecodeStats* stats) {
+  CompilerSettings settings{ CompileDepth::FullDecompile };
+  settings.stats = stats;
+  // the spirv backend drops comment nodes
+  settings.emit_comments = false;
+  return settings;
+}
+
+DeviceSettings GetDeviceSettings() {
+  DeviceSettings device_settings{};
+  device_settings.IsFloat16Supported = false;
+  device_settings.IsWarpSizePotentiallyBiggerThanGuest = true;
+  device_settings.IsFormatlessImageLoadSupported = true;
+  device_settings.IsNvViewportSwizzleSupported = false;
+  device_settings.IsKhrUniformBufferStandardLayoutSupported = false;
+  device_settings.IsExtIndexTypeUint8Supported = false;
+  device_settings.IsExtDepthRangeUnrestrictedSupported = true;
+  device_settings.IsExtShaderViewportIndexLayerSupported = true;
+  device_settings.IsExtTransformFeedbackSupported = false;
+  device_settings.IsExtCustomBorderColorSupported = false;
+  device_settings.IsExtExtendedDynamicStateSupported = false;
+  return device_settings;
+}
+
+// dictionary entry of the resource bound to a slot
+std::optional<u32> FindResourceBySlot(const BNSHResourceList& resources, s32 slot) {
+  for (size_t ii = 0; ii < resources.size(); ++ii) {
+    if (resources[ii].slot == slot) return static_cast<u32>(ii);
+  }
+  return std::nullopt;
+}
+
+// maps the emulated index of every sampler to its entry in the reflected sampler dictionary, the
+// smp and slt half of getSamplerBindingIndices in the README. Texture handles are laid out in slot
+// order, so the decoded sampler with the n-th lowest handle is on the n-th lowest reflected slot.
+// Like the js, this needs one decoded sampler per dictionary entry. Returns an empty map if they
+// can't be paired, the samplers are then bound sequentially
+std::map<u32, u32> MatchSamplerSlots(const std::list<Sampler>& samplers,
+                                     const BNSHResourceList& resources) {
+  if (samplers.empty() || samplers.size() != resources.size()) return {};
+
+  // smp: the decoded samplers in handle order
+  std::vector<std::pair<u32, u32>> handles;
+  std::optional<u32> handleBuffer;
+  for (const Sampler& sampler : samplers) {
+    if (sampler.is_separated) return {};
+    // bound handles are word indices into the bound texture buffer, bindless ones byte offsets
+    const u32 buffer = sampler.is_bindless ? sampler.buffer : ~0U;
+    if (handleBuffer && *handleBuffer != buffer) return {};
+    handleBuffer = buffer;
+    handles.emplace_back(sampler.is_bindless ? sampler.offset / 4 : sampler.offset, sampler.index);
+  }
+  std::sort(handles.begin(), handles.end());
+
+  // slt: the dictionary entries in slot order
+  std::vector<std::pair<s32, u32>> slots;
+  for (size_t ii = 0; ii < resources.size(); ++ii) {
+    if (resources[ii].slot < 0) return {};
+    slots.emplace_back(resources[ii].slot, static_cast<u32>(ii));
+  }
+  std::sort(slots.begin(), slots.end());
+
+  std::map<u32, u32> entries;
+  for (size_t ii = 0; ii < handles.size(); ++ii) {
+    // samplers sharing a handle or entries sharing a slot can't be told apart
+    if (ii > 0 && (handles[ii].first == handles[ii - 1].first ||
+                   slots[ii].first == slots[ii - 1].first)) {
+      return {};
+    }
+    entries.emplace(handles[ii].second, slots[ii].second);
+  }
+  return entries;
+}
+
+// native version of the driver jump table resolution runtimes used to do per material: constant
+// buffers are bound in the order of the constant buffer dictionary, followed by a texture per
+// sampler dictionary entry and then a sampler per entry. The dictionary order takes the place of
+// the str array of getSamplerBindingIndices
+void ResolveBindings(const BNSHStageReflection& reflection, SPIRVData& out_data) {
+  const u32 constantBufferCount = static_cast<u32>(reflection.constantBuffers.size());
+  const u32 samplerCount = static_cast<u32>(reflection.samplers.size());
+  for (u32 ii = 0; ii < constantBufferCount; ++ii) {
+    const s32 slot = reflection.constantBuffers[ii].slot;
+    if (slot >= 0) out_data.constant_buffer_bindings[slot] = ii;
+  }
+  for (const auto& [index, entry] : out_data.sampler_entries) {
+    out_data.texture_bindings[index] = constantBufferCount + entry;
+    out_data.sampler_bindings[index] = constantBufferCount + samplerCount + entry;
+  }
+}
+
+// name and slot of a reflected resource
+void AppendJSONResource(std::string& json, const BNSHResource resource) {
+  json += ",";
+  json += "\"name\":";
+  AppendJSONString(json, resource.name);
+  json += ",";
+  json += "\"slot\":";
+  json += std::to_string(resource.slot);
+}
+
+// every entry of a reflected attribute dictionary, with the decoded attribute it maps to if the
+// shader uses it
+void AppendJSONAttributes(std::string& json, const BNSHResourceList& resources,
+                          const std::set<Attribute::Index>& attributes) {
+  json += "[";
+  for (size_t ii = 0; ii < resources.size(); ++ii) {
+    const BNSHResource resource = resources[ii];
+    json += "{";
+    json += "\"attribute\":";
+    const auto attribute = static_cast<Attribute::Index>(
+      static_cast<u64>(Attribute::Index::Attribute_0) + static_cast<u64>(resource.slot));
+    if (resource.slot >= 0 && attributes.count(attribute)) {
+      json += std::to_string(static_cast<u64>(attribute));
+    } else {
+      json += "null";
+    }
+    AppendJSONResource(json, resource);
+    json += "}";
+    if (ii < resources.size() - 1) json += ",";
+  }
+  json += "]";
+}
+
+// reads the reflection of a program found by following the bnsh container
+std::optional<BNSHStageReflection> ReadReflection(const u8* data, size_t dataSize,
+                                                  const std::optional<BNSHProgramCode>& program,
+                                                  const std::string& name, bool verbose) {
+  if (!program || !program->reflectionOffset) return std::nullopt;
+  BNSHStageReflection reflection{};
+  std::string error;
+  if (!ReadBNSHStageReflection(data, dataSize, *program, reflection, error)) {
+    if (verbose) fprintf(stdout, "%s: %s, ignoring the reflection data\n", name.c_str(), error.c_str());
+    return std::nullopt;
+  }
+  return reflection;
+}
+
+// compute programs take their workgroup size from the reflection
+SerializedRegistryInfo MakeRegistryInfo(ShaderType stage, const BNSHStageReflection* reflection) {
+  SerializedRegistryInfo info;
+  if (stage == ShaderType::Compute && reflection) {
+    info.compute.workgroup_size = reflection->workgroupSize;
+  }
+  return info;
+}
+
+// shared memory a compute program can address at most
+constexpr u32 MAX_SHARED_MEMORY_SIZE = 48 * 1024;
+// local memory of compute programs that address it dynamically and don't declare its size
+constexpr u32 FALLBACK_LOCAL_MEMORY_SIZE = 0x400;
+
+// shader ir of a program, every variant is emitted from it
+class DecodedShader {
+public:
+  DecodedShader(ProgramCodeView code, const BNSHStageReflection* reflection,
+                VideoCommon::Shader::DecodeStats* stats)
+    : stage{GetShaderStage(code)}, registry_info{MakeRegistryInfo(stage, reflection)},
+      registry{stage, registry_info}, shader_ir{code, 10, GetCompilerSettings(stats), registry} {}
+
+  ShaderType stage;
+  SerializedRegistryInfo registry_info;
+  Registry registry;
+  // the ir doesn't depend on the specialization, only the spirv backend consumes it
+  ShaderIR shader_ir;
+};
+
+// sizes the workgroup from the registry and the shared and local memory to the accesses of the
+// program, the maximum sizes are only declared if an access uses a dynamic address
+void SpecializeCompute(const DecodedShader& shader, Specialization& specialization) {
+  if (shader.stage != ShaderType::Compute) return;
+  specialization.workgroup_size = shader.registry.GetComputeInfo().workgroup_size;
+  // programs without reflection data run a single invocation per workgroup
+  for (u32& size : specialization.workgroup_size) size = std::max(size, 1U);
+
+  const ShaderIR& shader_ir = shader.shader_ir;
+  specialization.shared_memory_size = shader_ir.GetSharedMemorySize().value_or(MAX_SHARED_MEMORY_SIZE);
+  if (const std::optional<u32> size = shader_ir.GetLocalMemorySize()) {
+    specialization.local_memory_size = *size;
+  } else {
+    const u64 headerSize = shader_ir.GetHeader().GetLocalMemorySize();
+    specialization.local_memory_size =
+      headerSize ? static_cast<u32>(headerSize) : FALLBACK_LOCAL_MEMORY_SIZE;
+  }
+}
+
+std::bitset<32> GetGenericAttributeMask(const std::set<Attribute::Index>& attributes) {
+  std::bitset<32> mask;
+  for (const Attribute::Index attribute : attributes) {
+    if (attribute >= Attribute::Index::Attribute_0 && attribute <= Attribute::Index::Attribute_31) {
+      mask.set(static_cast<u32>(attribute) - static_cast<u32>(Attribute::Index::Attribute_0));
+    }
+  }
+  return mask;
+}
+
+// drops the generic attributes outside of the linked varyings
+std::set<Attribute::Index> GetLinkedAttributes(const std::set<Attribute::Index>& attributes,
+                                               const std::bitset<32>& linked) {
+  std::set<Attribute::Index> out;
+  for (const Attribute::Index attribute : attributes) {
+    const std::bitset<32> mask = GetGenericAttributeMask({ attribute });
+    if (mask.none() || (mask & linked).any()) out.insert(attribute);
+  }
+  return out;
+}
+
+std::vector<SPIRVData> EmitShaderVariants(const DecodedShader& shader,
+                                          const std::vector<DecodeVariant>& variants,
+                                          const BNSHStageReflection* reflection,
+                                          const std::optional<std::bitset<32>>& linked_varyings,
+                                          VideoCommon::Shader::DecodeStats* stats) {
+  const ShaderIR& shader_ir = shader.shader_ir;
+  DeviceSettings device_settings = GetDeviceSettings();
+
+  std::map<u32, u32> sampler_entries;
+  if (reflection) sampler_entries = MatchSamplerSlots(shader_ir.GetSamplers(), reflection->samplers);
+
+  std::vector<SPIRVData> out_data(variants.size());
+  for (size_t ii = 0; ii < variants.size(); ++ii) {
+    out_data[ii].reflection = reflection;
+    out_data[ii].sampler_entries = sampler_entries;
+    if (reflection && variants[ii].resolve_bindings) ResolveBindings(*reflection, out_data[ii]);
+
+    Specialization specialization =
+      GetSpecialization(variants[ii].base_binding_index, variants[ii].input_varyings);
+    specialization.const_buffer_bindings = out_data[ii].constant_buffer_bindings;
+    specialization.texture_bindings = out_data[ii].texture_bindings;
+    specialization.sampler_bindings = out_data[ii].sampler_bindings;
+    specialization.linked_varyings = linked_varyings;
+    SpecializeCompute(shader, specialization);
+
+    out_data[ii].spirv = VideoCommon::Shader::Decompile(
+      device_settings, shader_ir, shader.stage, shader.registry, specialization, stats);
+    out_data[ii].samplers = shader_ir.GetSamplers();
+    out_data[ii].constant_buffers = shader_ir.GetConstantBuffers();
+    out_data[ii].input_attributes = shader_ir.GetInputAttributes();
+    out_data[ii].output_attributes = shader_ir.GetOutputAttributes();
+    if (linked_varyings) {
+      // vertex inputs are vertex attributes, not varyings
+      if (shader.stage != ShaderType::Vertex) {
+        out_data[ii].input_attributes =
+          GetLinkedAttributes(out_data[ii].input_attributes, *linked_varyings);
+      }
+      out_data[ii].output_attributes =
+        GetLinkedAttributes(out_data[ii].output_attributes, *linked_varyings);
+    }
+  }
+  return out_data;
+}
+
+// bump whenever the decoder output changes, invalidates cached decode results
+//   2: bindless jump tables resolved into the emitted bindings
+//   3: reflection dictionary names and slots exported in the json
+//   4: varyings pruned between linked stages
+//   5: compute workgroup and memory sizes taken from the reflection
+//   6: per-instruction comment nodes made optional
+//   7: samplers matched to reflected slots in handle order
+constexpr u32 DECODER_VERSION = 7;
+
+}  // namespace
+
+void AppendJSONString(std::string& json, std::string_view value) {
+  json += "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      json += fmt::format("\\u{:04x}", c);
+    } else {
+      json += c;
+    }
+  }
+  json += "\"";
+}
+
+std::string GenerateJSON(SPIRVData& spirv_data) {
+  std::string json = "";
+  json += "{";
+  // write spirv length
+  {
+    json += "\"spirvLength\":";
+    json += std::to_string(spirv_data.spirv.size());
+  }
+  json += ",";
+  // write constantBuffers
+  {
+    json += "\"constantBuffers\":[";
+    uint32_t counter = 0;
+    for (const auto& [index, size] : spirv_data.constant_buffers) {
+      json += "{";
+      json += "\"index\":";
+      json += std::to_string(index);
+      json += ",";
+      json += "\"maxOffset\":";
+      json += std::to_string(size.GetMaxOffset());
+      json += ",";
+      json += "\"size\":";
+      json += std::to_string(size.GetSize());
+      if (spirv_data.reflection) {
+        const BNSHResourceList& resources = spirv_data.reflection->constantBuffers;
+        const std::optional<u32> entry = FindResourceBySlot(resources, static_cast<s32>(index));
+        if (entry) AppendJSONResource(json, resources[*entry]);
+      }
+      if (const auto it = spirv_data.constant_buffer_bindings.find(index);
+          it != spirv_data.constant_buffer_bindings.end()) {
+        json += ",";
+        json += "\"binding\":";
+        json += std::to_string(it->second);
+      }
+      json += "}";
+      if (counter++ < spirv_data.constant_buffers.size() - 1) json += ",";
+    }
+    json += "]";
+  }
+  json += ",";
+  // write samplers
+  {
+    json += "\"samplers\":[";
+    uint32_t counter = 0;
+    for (const auto& sampler : spirv_data.samplers) {
+      json += "{";
+      json += "\"index\":";
+      json += std::to_string(sampler.index);
+      json += ",";
+      json += "\"offset\":";
+      json += std::to_string(sampler.offset);
+      json += ",";
+      json += "\"isShadow\":";
+      json += std::to_string(sampler.is_shadow);
+      if (const auto it = spirv_data.sampler_entries.find(sampler.index);
+          it != spirv_data.sampler_entries.end()) {
+        AppendJSONResource(json, spirv_data.reflection->samplers[it->second]);
+      }
+      if (const auto it = spirv_data.texture_bindings.find(sampler.index);
+          it != spirv_data.texture_bindings.end()) {
+        json += ",";
+        json += "\"textureBinding\":";
+        json += std::to_string(it->second);
+        json += ",";
+        json += "\"samplerBinding\":";
+        json += std::to_string(spirv_data.sampler_bindings[sampler.index]);
+      }
+      json += "}";
+      if (counter++ < spirv_data.samplers.size() - 1) json += ",";
+    }
+    json += "]";
+  }
+  json += ",";
+  // input attributes
+  {
+    json += "\"inputAttributes\":[";
+    uint32_t counter = 0;
+    for (const auto& attr : spirv_data.input_attributes) {
+      json += std::to_string(static_cast<u64>(attr));
+      if (counter++ < spirv_data.input_attributes.size() - 1) json += ",";
+    }
+    json += "]";
+  }
+  json += ",";
+  // output attributes
+  {
+    json += "\"outputAttributes\":[";
+    uint32_t counter = 0;
+    for (const auto& attr : spirv_data.output_attributes) {
+      json += std::to_string(static_cast<u64>(attr));
+      if (counter++ < spirv_data.output_attributes.size() - 1) json += ",";
+    }
+    json += "]";
+  }
+  // reflected inputs and outputs
+  if (spirv_data.reflection) {
+    json += ",";
+    json += "\"inputs\":";
+    AppendJSONAttributes(json, spirv_data.reflection->inputs, spirv_data.input_attributes);
+    json += ",";
+    json += "\"outputs\":";
+    AppendJSONAttributes(json, spirv_data.reflection->outputs, spirv_data.output_attributes);
+  }
+  json += "}";
+  json += "\0";
+  return json;
+}
+
+std::vector<SPIRVData> DecodeShaderVariants(ProgramCodeView code,
+                                            const std::vector<DecodeVariant>& variants,
+                                            const BNSHStageReflection* reflection,
+                                            VideoCommon::Shader::DecodeStats* stats) {
+  const DecodedShader shader(code, reflection, stats);
+  return EmitShaderVariants(shader, variants, reflection, std::nullopt, stats);
+}
+
+std::pair<std::vector<SPIRVData>, std::vector<SPIRVData>> DecodeLinkedShaderVariants(
+  const LinkedStage& vertex, const LinkedStage& fragment,
+  const std::vector<DecodeVariant>& variants) {
+  const DecodedShader vertexShader(vertex.code, vertex.reflection, nullptr);
+  const DecodedShader fragmentShader(fragment.code, fragment.reflection, nullptr);
+
+  // only varyings the vertex shader writes and the fragment shader reads are kept
+  const std::bitset<32> linked = GetGenericAttributeMask(vertexShader.shader_ir.GetOutputAttributes()) &
+                                 GetGenericAttributeMask(fragmentShader.shader_ir.GetInputAttributes());
+
+  return {
+    EmitShaderVariants(vertexShader, variants, vertex.reflection, linked, nullptr),
+    EmitShaderVariants(fragmentShader, variants, fragment.reflection, linked, nullptr)
+  };
+}
+
+std::string GenerateStatsJSON(const std::vector<ShaderStats>& stats) {
+  const auto field = [](std::string& json, const char* name, u64 value) {
+    json += "\"";
+    json += name;
+    json += "\":";
+    json += std::to_string(value);
+  };
+  std::string json = "";
+  json += "{\"shaders\":[";
+  for (size_t ii = 0; ii < stats.size(); ++ii) {
+    const ShaderStats& shader = stats[ii];
+    const VideoCommon::Shader::DecodeStats& decode = shader.decode;
+    json += "{";
+    json += "\"name\":";
+    AppendJSONString(json, shader.name);
+    json += ",";
+    json += "\"success\":";
+    json += shader.success ? "true" : "false";
+    json += ",";
+    json += "\"duplicate\":";
+    json += shader.duplicate ? "true" : "false";
+    json += ",";
+    // only known if the shader ir was built, i.e. not every variant came from the cache
+    json += "\"compileDepth\":";
+    if (shader.variants > shader.cachedVariants) {
+      json += "\"";
+      json += VideoCommon::Shader::CompileDepthAsString(decode.depth);
+      json += "\"";
+    } else {
+      json += "null";
+    }
+    json += ",";
+    field(json, "variants", shader.variants);
+    json += ",";
+    field(json, "cachedVariants", shader.cachedVariants);
+    json += ",";
+    field(json, "bytecodeInstructions", shader.bytecodeInstructions);
+    json += ",";
+    field(json, "flowBlocks", decode.flow_blocks);
+    json += ",";
+    field(json, "decodedInstructions", decode.decoded_instructions);
+    json += ",";
+    field(json, "spirvWords", decode.spirv_words);
+    json += ",";
+    // exclusive wall time of each phase in nanoseconds
+    json += "\"timeNs\":{";
+    field(json, "extract", shader.extract.count());
+    json += ",";
+    field(json, "scanFlow", (decode.scan_flow - decode.ast_decompile).count());
+    json += ",";
+    field(json, "astDecompile", decode.ast_decompile.count());
+    json += ",";
+    field(json, "decode", (decode.decode - decode.scan_flow).count());
+    json += ",";
+    field(json, "postDecode", decode.post_decode.count());
+    json += ",";
+    field(json, "spirvConstruct", decode.spirv_construct.count());
+    json += ",";
+    field(json, "spirvAssemble", decode.spirv_assemble.count());
+    json += ",";
+    field(json, "json", shader.json.count());
+    json += "}";
+    json += "}";
+    if (ii < stats.size() - 1) json += ",";
+  }
+  json += "]}";
+  return json;
+}
+
+std::string GenerateDuplicateJSON(const std::string& json, const std::string& spirvFile) {
+  std::string out = "{";
+  out += "\"spirvFile\":";
+  AppendJSONString(out, spirvFile);
+  if (json.size() > 2) out += ",";
+  out.append(json, 1);
+  return out;
+}
+
+SPIRVData DecodeShader(
+  uint32_t len_raw_data, const u64* raw_data,
+  uint8_t base_binding_index,
+  uint32_t len_raw_input_varyings, const uint8_t* raw_input_varyings
+) {
+  // decode straight from the caller's memory, no copy
+  ProgramCodeView code(raw_data, len_raw_data / sizeof(u64));
+
+  DecodeVariant variant{};
+  variant.base_binding_index = base_binding_index;
+  variant.input_varyings.assign(raw_input_varyings, raw_input_varyings + len_raw_input_varyings);
+
+  return std::move(DecodeShaderVariants(code, { variant })[0]);
+}
+
+u64 ComputeDecodeKey(ProgramCodeView code, const DecodeVariant& variant,
+                     const BNSHStageReflection* reflection, ProgramCodeView linked) {
+  const Specialization specialization =
+    GetSpecialization(variant.base_binding_index, variant.input_varyings);
+  const DeviceSettings device_settings = GetDeviceSettings();
+
+  std::vector<u8> key;
+  const auto append = [&key](const auto& value) {
+    static_assert(std::is_trivially_copyable_v<std::decay_t<decltype(value)>>);
+    const u8* bytes = reinterpret_cast<const u8*>(&value);
+    key.insert(key.end(), bytes, bytes + sizeof(value));
+  };
+  append(DECODER_VERSION);
+  append(specialization.base_binding);
+  append(specialization.workgroup_size);
+  append(specialization.shared_memory_size);
+  append(specialization.point_size.has_value());
+  append(specialization.point_size.value_or(0.0f));
+  append(specialization.enabled_attributes.to_ullong());
+  append(specialization.attribute_types);
+  append(static_cast<u32>(specialization.custom_input_varyings.size()));
+  key.insert(key.end(), specialization.custom_input_varyings.begin(),
+             specialization.custom_input_varyings.end());
+  append(specialization.ndc_minus_one_to_one);
+  append(device_settings);
+  append(variant.resolve_bindings);
+  append(linked.size() != 0);
+  if (linked.size()) {
+    append(Common::CityHash64(reinterpret_cast<const char*>(linked.data()),
+                              linked.size() * sizeof(u64)));
+  }
+  append(reflection != nullptr);
+  if (reflection) {
+    append(reflection->workgroupSize);
+    for (const BNSHResourceList* resources :
+         { &reflection->inputs, &reflection->outputs, &reflection->samplers,
+           &reflection->constantBuffers, &reflection->unorderedAccessBuffers,
+           &reflection->images }) {
+      append(static_cast<u32>(resources->size()));
+      for (const BNSHResource resource : *resources) {
+        append(resource.slot);
+        append(static_cast<u32>(resource.name.size()));
+        key.insert(key.end(), resource.name.begin(), resource.name.end());
+      }
+    }
+  }
+
+  return Common::CityHash64WithSeed(reinterpret_cast<const char*>(code.data()),
+                                    code.size() * sizeof(u64),
+                                    Common::ComputeHash64(key.data(), key.size()));
+}
+
+ProgramCodeView ProgramSource::Code() const {
+  if (!buffer.empty()) return buffer;
+  const u8* data = mapping.IsOpen() ? mapping.Data() : fileData.data();
+  return ProgramCodeView(reinterpret_cast<const u64*>(data + codeOffset), codeSize / sizeof(u64));
+}
+
+std::optional<size_t> FindProgramCodeOffset(const u8* data, size_t dataSize,
+                                            const std::string& name, bool verbose,
+                                            std::optional<BNSHProgramCode>* program,
+                                            const ProgramSelection* selection,
+                                            std::string* error) {
+  const auto fail = [&](const std::string& message) {
+    if (error) {
+      *error = message;
+    } else {
+      fprintf(stderr, "%s: %s\n", name.c_str(), message.c_str());
+    }
+    return std::nullopt;
+  };
+  const auto readU32 = [data](size_t offset) {
+    u32 value;
+    std::memcpy(&value, data + offset, sizeof(value));
+    return value;
+  };
+
+  if (dataSize < sizeof(u32)) return fail("Unsupported data");
+
+  u32 magic = readU32(0);
+
+  // bnsh file, follow the container to the bytecode
+  if (magic == BNSH_MAGIC) {
+    if (verbose) fprintf(stdout, "Detected BNSH file\n");
+    BNSHIndex index{};
+    std::optional<BNSHProgramCode> code;
+    std::string indexError;
+    bool found = ReadBNSHIndex(data, dataSize, index, indexError);
+    if (found && verbose && index.name.size()) fprintf(stdout, "Shader name %s\n", index.name.c_str());
+    if (found && selection) {
+      // only the selected program is read
+      if (FindBNSHProgramCode(data, dataSize, index, selection->variation, selection->stage, code,
+                              indexError) && !code) {
+        indexError = selection->stage ?
+          fmt::format("Variation {} has no binary {} program", selection->variation,
+                      GetBNSHStageName(*selection->stage)) :
+          fmt::format("Variation {} has no binary program", selection->variation);
+      }
+    } else if (found) {
+      // the first program, usually the one of the first variation
+      for (u32 variation = 0; variation < index.variationCount && !code; ++variation) {
+        if (!FindBNSHProgramCode(data, dataSize, index, variation, std::nullopt, code, indexError)) break;
+      }
+      if (!code && indexError.empty()) indexError = "No binary shader programs";
+      if (code && verbose && index.variationCount > 1) {
+        fprintf(stdout, "Multiple BNSH shader programs aren't supported, falling back to the %s program of variation %u\n",
+                GetBNSHStageName(code->stage), code->variation);
+      }
+    }
+    if (code) {
+      if (verbose) fprintf(stdout, "Found BNSH bytecode at 0x%zX\n", code->offset);
+      if (program) *program = code;
+      return code->offset;
+    }
+    if (selection) return fail(indexError);
+    if (verbose) fprintf(stdout, "%s, scanning for the bytecode section instead\n", indexError.c_str());
+
+    // containers the reader doesn't understand, find the first bytecode section by its magic
+    size_t dataU32Len = dataSize / sizeof(u32);
+    size_t byteCodeOffset = 0x0;
+    size_t magicIndex = Common::FindWord32(data, dataU32Len, NVN_BYTECODE_MAGIC, NVN_BYTECODE_MAGIC);
+    if (magicIndex < dataU32Len) {
+      byteCodeOffset = magicIndex * sizeof(u32) + NVN_BYTECODE_HEADER_SIZE;
+    }
+    if (byteCodeOffset == 0x0 || byteCodeOffset >= dataSize) {
+      return fail("Missing BNSH bytecode section");
+    }
+    if (verbose) fprintf(stdout, "Found BNSH bytecode at 0x%zX\n", byteCodeOffset);
+    return byteCodeOffset;
+  }
+  if (selection) return fail("Selecting a program requires a BNSH file");
+  // got directly fed the binary section
+  if (magic == NVN_BYTECODE_MAGIC) {
+    return 0;
+  }
+  return fail("Unsupported data");
+}
+
+std::optional<ProgramCode> ExtractProgramCode(const u8* data, size_t dataSize,
+                                              const std::string& name, bool verbose,
+                                              std::optional<BNSHProgramCode>* program) {
+  std::optional<BNSHProgramCode> found;
+  std::optional<size_t> offset = FindProgramCodeOffset(data, dataSize, name, verbose, &found);
+  if (!offset) return std::nullopt;
+  // bytecode of a program found in the container ends with the program, like in LoadFileProgramCode
+  const size_t codeSize = found ? found->size : dataSize - *offset;
+  ProgramCode out((codeSize + sizeof(u64) - 1) / sizeof(u64));
+  std::memcpy(out.data(), data + *offset, codeSize);
+  if (program) *program = found;
+  return out;
+}
+
+std::optional<ProgramSource> LoadFileProgramCode(const std::string& fileName, bool verbose,
+                                                 const ProgramSelection* selection) {
+  ProgramSource source{};
+
+  // map the file, or read it for files which can't be mapped
+  if (!source.mapping.Open(fileName)) {
+    std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+      fprintf(stderr, "%s: Failed to open file!\n", fileName.c_str());
+      return std::nullopt;
+    }
+    source.fileData.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(source.fileData.data()), source.fileData.size());
+  }
+  const u8* data = source.mapping.IsOpen() ? source.mapping.Data() : source.fileData.data();
+  const size_t dataSize = source.mapping.IsOpen() ? source.mapping.Size() : source.fileData.size();
+
+  std::optional<BNSHProgramCode> program;
+  std::optional<size_t> offset =
+    FindProgramCodeOffset(data, dataSize, fileName, verbose, &program, selection);
+  if (!offset) return std::nullopt;
+  source.reflection = ReadReflection(data, dataSize, program, fileName, verbose);
+  // bytecode of a program found in the container ends with the program, anything else runs to
+  // the end of the data
+  source.codeOffset = *offset;
+  source.codeSize = program ? program->size : dataSize - *offset;
+  // the decoder reads the whole header and the first instructions unchecked
+  if (source.codeSize < MIN_PROGRAM_SIZE) {
+    fprintf(stderr, "%s: Truncated shader program\n", fileName.c_str());
+    return std::nullopt;
+  }
+
+  // view the bytecode in place if the file keeps it u64 aligned
+  if (reinterpret_cast<uintptr_t>(data + source.codeOffset) % alignof(u64) != 0) {
+    source.buffer.assign((source.codeSize + sizeof(u64) - 1) / sizeof(u64), 0);
+    std::memcpy(source.buffer.data(), data + source.codeOffset, source.codeSize);
+    // only the reflection still views the file
+    if (!source.reflection) {
+      source.mapping.Close();
+      source.fileData = {};
+    }
+  }
+  return source;
+}
+
+std::string InsertFileNameSuffix(const std::string& fileName, const std::string& suffix) {
+  if (suffix.empty()) return fileName;
+  std::filesystem::path path(fileName);
+  path.replace_extension(suffix + path.extension().string());
+  return path.string();
+}
+
+bool WriteOutputFile(const std::string& fileName, const void* data, size_t size) {
+  FILE* pFile;
+  pFile = fopen(fileName.c_str(), "w+b");
+  if (!pFile) {
+    fprintf(stderr, "%s: Failed to open file for writing!\n", fileName.c_str());
+    return false;
+  }
+  bool success = fwrite(data, sizeof(char), size, pFile) == size;
+  success &= fclose(pFile) == 0;
+  if (!success) {
+    fprintf(stderr, "%s: Failed to write file!\n", fileName.c_str());
+  }
+  return success;
+}
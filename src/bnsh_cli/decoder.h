@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bnsh_cli/bnsh_file.h"
+#include "common/common_types.h"
+#include "common/mapped_file.h"
+#include "video_core/engines/shader_bytecode.h"
+#include "video_core/shader/shader_ir.h"
+
+typedef struct SPIRVData {
+  std::vector<u32> spirv;
+  std::list<VideoCommon::Shader::Sampler> samplers;
+  std::map<u32, VideoCommon::Shader::ConstBuffer> constant_buffers;
+  std::set<Tegra::Shader::Attribute::Index> input_attributes;
+  std::set<Tegra::Shader::Attribute::Index> output_attributes;
+  // reflection passed to the decode, if any, must outlive the data
+  const BNSHStageReflection* reflection = nullptr;
+  // entry of each sampler in the reflected sampler dictionary, keyed by sampler index
+  std::map<u32, u32> sampler_entries;
+  // bindings resolved from the stage reflection, keyed by const buffer and sampler index
+  std::map<u32, u32> constant_buffer_bindings;
+  std::map<u32, u32> texture_bindings;
+  std::map<u32, u32> sampler_bindings;
+} SPIRVData;
+
+// spirv and reflection json of a decoded shader
+typedef struct DecodeOutput {
+  std::vector<u32> spirv;
+  std::string json;
+} DecodeOutput;
+
+// specialization of one emitted variant of a shader
+typedef struct DecodeVariant {
+  uint8_t base_binding_index = 0;
+  std::vector<u8> input_varyings{};
+  // binds resources in the order of the stage reflection if the decode gets one
+  bool resolve_bindings = false;
+  // appended to output names when several variants are emitted
+  std::string suffix{};
+} DecodeVariant;
+
+// per shader timings and counters reported by --stats
+typedef struct ShaderStats {
+  std::string name;
+  VideoCommon::Shader::DecodeStats decode{};
+  std::chrono::nanoseconds extract{};
+  std::chrono::nanoseconds json{};
+  u32 bytecodeInstructions = 0;
+  u32 variants = 0;
+  u32 cachedVariants = 0;
+  // identical to an earlier program of the run and not decoded again
+  bool duplicate = false;
+  bool success = false;
+} ShaderStats;
+
+// builds the shader ir once and only reruns the spirv backend for each variant. The names and
+// slots of a passed stage reflection are added to the json, and variants with resolve_bindings
+// bind constant buffers and samplers in its dictionary order instead of sequentially
+std::vector<SPIRVData> DecodeShaderVariants(VideoCommon::Shader::ProgramCodeView code,
+                                            const std::vector<DecodeVariant>& variants,
+                                            const BNSHStageReflection* reflection = nullptr,
+                                            VideoCommon::Shader::DecodeStats* stats = nullptr);
+
+// program of one stage of a linked decode
+typedef struct LinkedStage {
+  VideoCommon::Shader::ProgramCodeView code;
+  const BNSHStageReflection* reflection = nullptr;
+} LinkedStage;
+
+// decodes the vertex and fragment program of a variation together, generic varyings that only
+// one of them uses are removed from both. Returns the vertex and the fragment variants
+std::pair<std::vector<SPIRVData>, std::vector<SPIRVData>> DecodeLinkedShaderVariants(
+  const LinkedStage& vertex, const LinkedStage& fragment,
+  const std::vector<DecodeVariant>& variants);
+
+// raw_data must be u64 aligned and outlive the call, it's decoded in place
+SPIRVData DecodeShader(
+  uint32_t len_raw_data, const u64* raw_data,
+  uint8_t base_binding_index,
+  uint32_t len_raw_input_varyings, const uint8_t* raw_input_varyings
+);
+
+std::string GenerateJSON(SPIRVData& spirv_data);
+
+std::string GenerateStatsJSON(const std::vector<ShaderStats>& stats);
+
+// json of a duplicate program, which references the spirv file of the first occurrence instead
+// of storing its own copy
+std::string GenerateDuplicateJSON(const std::string& json, const std::string& spirvFile);
+
+// appends value as a json string literal, escaping quotes, backslashes and control characters
+void AppendJSONString(std::string& json, std::string_view value);
+
+// hashes the bytecode together with every setting that influences the decoded output, linked is
+// the program of the other stage of a linked decode
+u64 ComputeDecodeKey(VideoCommon::Shader::ProgramCodeView code, const DecodeVariant& variant,
+                     const BNSHStageReflection* reflection = nullptr,
+                     VideoCommon::Shader::ProgramCodeView linked = {});
+
+// shader program header plus at least one instruction bundle
+constexpr size_t MIN_PROGRAM_SIZE = 0x50 + 4 * sizeof(u64);
+
+// program code of an input, viewed in place in a file mapping or copied into a buffer
+typedef struct ProgramSource {
+  Common::MappedFile mapping;
+  // contents of inputs which can't be mapped
+  std::vector<u8> fileData;
+  // byte range of the bytecode inside the file
+  size_t codeOffset = 0;
+  size_t codeSize = 0;
+  // aligned copy of bytecode the file doesn't keep u64 aligned
+  VideoCommon::Shader::ProgramCode buffer;
+  // resource layout of the program, only known for bnsh files with reflection data. Views the
+  // file, which is kept open for it
+  std::optional<BNSHStageReflection> reflection;
+
+  VideoCommon::Shader::ProgramCodeView Code() const;
+} ProgramSource;
+
+// program of a bnsh file to decode instead of the first one
+typedef struct ProgramSelection {
+  uint32_t variation = 0;
+  // first stage of the variation if unset
+  std::optional<BNSHStage> stage;
+} ProgramSelection;
+
+// finds the byte offset of the bytecode section of a bnsh file or raw bytecode section, program
+// is set if the bytecode was found by following the bnsh container. With a selection only the
+// selected program of a bnsh file is read. The reason of a failure is stored in error, or
+// reported to stderr if error is null
+std::optional<size_t> FindProgramCodeOffset(const u8* data, size_t dataSize,
+                                            const std::string& name, bool verbose = true,
+                                            std::optional<BNSHProgramCode>* program = nullptr,
+                                            const ProgramSelection* selection = nullptr,
+                                            std::string* error = nullptr);
+
+// copies the bytecode section of an in-memory bnsh file or raw bytecode section, program is set
+// if the bytecode was found by following the bnsh container
+std::optional<VideoCommon::Shader::ProgramCode> ExtractProgramCode(
+  const u8* data, size_t dataSize,
+  const std::string& name, bool verbose = true,
+  std::optional<BNSHProgramCode>* program = nullptr);
+
+// loads a bnsh file or a raw bytecode section, reports errors to stderr
+std::optional<ProgramSource> LoadFileProgramCode(const std::string& fileName,
+                                                 bool verbose = true,
+                                                 const ProgramSelection* selection = nullptr);
+
+// inserts a suffix in front of the extension, shader.spv becomes shader.b4.spv for .b4
+std::string InsertFileNameSuffix(const std::string& fileName, const std::string& suffix);
+
+// writes a whole buffer into a file, reports errors to stderr
+bool WriteOutputFile(const std::string& fileName, const void* data, size_t size);
@@ -0,0 +1,39 @@
+#include "bnsh_cli/bundle.h"
+#include "bnsh_cli/output_writer.h"
+
+OutputWriter::OutputWriter(size_t capacity, BundleWriter* bundle)
+  : queue{capacity}, bundle{bundle}, thread{&OutputWriter::Run, this} {}
+
+OutputWriter::~OutputWriter() {
+  Finish();
+}
+
+void OutputWriter::Write(std::vector<Output>&& outputs, Callback done) {
+  queue.Push({ std::move(outputs), std::move(done) });
+}
+
+void OutputWriter::Finish() {
+  queue.Close();
+  if (thread.joinable()) thread.join();
+}
+
+void OutputWriter::Run() {
+  while (std::optional<Job> job = queue.Pop()) {
+    bool success = true;
+    for (const Output& file : job->outputs) {
+      const DecodeOutput& output = file.output;
+      if (bundle && file.bundleName.size()) {
+        success &= bundle->Add(file.bundleName, output);
+        continue;
+      }
+      if (file.jsonFile.size()) {
+        success &= WriteOutputFile(file.jsonFile, output.json.data(), output.json.size());
+      }
+      if (file.spirvFile.size()) {
+        success &= WriteOutputFile(file.spirvFile, output.spirv.data(),
+                                   output.spirv.size() * sizeof(u32));
+      }
+    }
+    if (job->done) job->done(success);
+  }
+}
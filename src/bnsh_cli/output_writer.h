@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bnsh_cli/decoder.h"
+#include "common/bounded_queue.h"
+
+class BundleWriter;
+
+// Writes decode outputs on a dedicated thread, so decode workers overlap with disk io instead
+// of stalling on it. Queued writes are bounded, producers block once the writer falls behind.
+class OutputWriter {
+public:
+  // runs on the writer thread once every output of a write is done, with whether all of them
+  // succeeded. Writes complete in the order they were queued
+  typedef std::function<void(bool success)> Callback;
+
+  // one decode output, files with an empty name aren't written
+  typedef struct Output {
+    std::string jsonFile;
+    std::string spirvFile;
+    // added to the bundle under this name instead of writing files, if the writer has a bundle
+    std::string bundleName;
+    DecodeOutput output;
+  } Output;
+
+  // outputs with a bundle name are added to bundle, which may be null if there are none
+  explicit OutputWriter(size_t capacity, BundleWriter* bundle = nullptr);
+  ~OutputWriter();
+
+  // queues the outputs of one input, they're moved out
+  void Write(std::vector<Output>&& outputs, Callback done = {});
+  // waits until everything queued is written
+  void Finish();
+
+private:
+  typedef struct Job {
+    std::vector<Output> outputs;
+    Callback done;
+  } Job;
+
+  void Run();
+
+  Common::BoundedQueue<Job> queue;
+  BundleWriter* bundle;
+  std::thread thread;
+};
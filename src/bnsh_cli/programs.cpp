@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+
+#include <fmt/format.h>
+
+#include "bnsh_cli/bnsh_file.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/output_writer.h"
+#include "bnsh_cli/programs.h"
+#include "common/assert.h"
+#include "common/mapped_file.h"
+
+namespace {
+
+using VideoCommon::Shader::ProgramCode;
+using VideoCommon::Shader::ProgramCodeView;
+
+typedef struct ProgramJob {
+  BNSHProgramCode program;
+  ProgramCodeView code;
+  // aligned copy for programs the mapping doesn't keep u64 aligned
+  ProgramCode buffer;
+  std::optional<BNSHStageReflection> reflection;
+  // fragment job decoded together with this vertex job, if linked
+  ProgramJob* linked = nullptr;
+  // earlier job with the same bytecode whose results are reused, if deduplicated
+  ProgramJob* original = nullptr;
+  std::vector<DecodeOutput> results;
+  bool success = false;
+  // set once a worker is done with the job, guarded by the finished mutex
+  bool finished = false;
+} ProgramJob;
+
+}  // namespace
+
+int RunAllPrograms(const ProgramsOptions& options) {
+  Common::MappedFile file;
+  if (!file.Open(options.input)) {
+    fprintf(stderr, "%s: Failed to open file!\n", options.input.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BNSHProgramCode> programs;
+  std::string error;
+  if (!ReadBNSHProgramCodes(file.Data(), file.Size(), programs, error)) {
+    fprintf(stderr, "%s: %s\n", options.input.c_str(), error.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::vector<ProgramJob> jobs(programs.size());
+  for (size_t ii = 0; ii < programs.size(); ++ii) {
+    ProgramJob& job = jobs[ii];
+    job.program = programs[ii];
+    const u8* data = file.Data() + job.program.offset;
+    if (job.program.offset % sizeof(u64) == 0) {
+      job.code = ProgramCodeView(reinterpret_cast<const u64*>(data), job.program.size / sizeof(u64));
+    } else {
+      job.buffer.resize((job.program.size + sizeof(u64) - 1) / sizeof(u64));
+      std::memcpy(job.buffer.data(), data, job.program.size);
+      job.code = job.buffer;
+    }
+    if (job.program.reflectionOffset) {
+      BNSHStageReflection reflection{};
+      if (ReadBNSHStageReflection(file.Data(), file.Size(), job.program, reflection, error)) {
+        job.reflection = std::move(reflection);
+      } else {
+        fprintf(stdout, "%s: Variation %u: %s, ignoring the reflection data\n",
+                options.input.c_str(), job.program.variation, error.c_str());
+      }
+    }
+  }
+
+  // the codes are ordered by variation and stage, so a variation's vertex program directly
+  // precedes its fragment program unless other stages sit in between
+  std::vector<ProgramJob*> units;
+  for (size_t ii = 0; ii < jobs.size(); ++ii) {
+    ProgramJob& job = jobs[ii];
+    if (options.linkVaryings && job.program.stage == BNSHStage::Fragment && !units.empty()) {
+      ProgramJob* vertex = units.back();
+      if (vertex->program.variation == job.program.variation &&
+          vertex->program.stage == BNSHStage::Vertex && !vertex->linked) {
+        vertex->linked = &job;
+        continue;
+      }
+    }
+    units.push_back(&job);
+  }
+
+  if (options.dedup) {
+    // units only share results with units of the same shape, a linked pair is keyed by both of
+    // its programs
+    std::map<std::pair<u64, u64>, ProgramJob*> originals;
+    std::vector<ProgramJob*> uniqueUnits;
+    for (ProgramJob* unit : units) {
+      const DecodeVariant& variant = options.variants.front();
+      const BNSHStageReflection* reflection = unit->reflection ? &*unit->reflection : nullptr;
+      std::pair<u64, u64> key{};
+      if (unit->linked) {
+        const ProgramJob& fragment = *unit->linked;
+        key.first = ComputeDecodeKey(unit->code, variant, reflection, fragment.code);
+        key.second = ComputeDecodeKey(fragment.code, variant,
+                                      fragment.reflection ? &*fragment.reflection : nullptr,
+                                      unit->code);
+      } else {
+        key.first = ComputeDecodeKey(unit->code, variant, reflection);
+      }
+      auto [it, inserted] = originals.try_emplace(key, unit);
+      if (inserted) {
+        uniqueUnits.push_back(unit);
+        continue;
+      }
+      unit->original = it->second;
+      if (unit->linked) unit->linked->original = it->second->linked;
+    }
+    units = std::move(uniqueUnits);
+  }
+
+  uint32_t threadCount = options.jobs ? options.jobs : std::thread::hardware_concurrency();
+  threadCount = std::max(1u, std::min<uint32_t>(threadCount, static_cast<uint32_t>(units.size())));
+
+  const auto stageOf = [](const ProgramJob& job) {
+    return LinkedStage{ job.code, job.reflection ? &*job.reflection : nullptr };
+  };
+
+  std::atomic<size_t> nextUnit{0};
+  std::mutex finishedMutex;
+  std::condition_variable finishedCondition;
+  const auto decode = [&](ProgramJob& job) {
+    if (job.code.size() * sizeof(u64) < MIN_PROGRAM_SIZE) return;
+    if (job.linked && job.linked->code.size() * sizeof(u64) < MIN_PROGRAM_SIZE) return;
+    // a program the decoder rejects only fails itself, not the whole file
+    try {
+      Common::ScopedRecoverableAsserts recoverableAsserts;
+      if (job.linked) {
+        std::tie(job.results, job.linked->results) = DecodeLinkedShaderVariantsCached(
+          options.cache, stageOf(job), stageOf(*job.linked), options.variants);
+        job.linked->success = true;
+      } else {
+        job.results = DecodeShaderVariantsCached(options.cache, job.code, options.variants,
+                                                 job.reflection ? &*job.reflection : nullptr);
+      }
+      job.success = true;
+    } catch (const Common::AssertionFailure&) {
+    } catch (const std::exception& e) {
+      fprintf(stderr, "%s: Variation %u: %s\n", options.input.c_str(), job.program.variation,
+              e.what());
+    }
+  };
+  const auto worker = [&]() {
+    for (size_t ii = nextUnit++; ii < units.size(); ii = nextUnit++) {
+      ProgramJob& job = *units[ii];
+      decode(job);
+      std::lock_guard lock{finishedMutex};
+      job.finished = true;
+      if (job.linked) job.linked->finished = true;
+      finishedCondition.notify_all();
+    }
+  };
+
+  // the calling thread hands the results to the writer while the workers decode
+  std::vector<std::thread> threads;
+  for (uint32_t ii = 0; ii < threadCount; ++ii) threads.emplace_back(worker);
+
+  // report and write in variation order, independent of the order the workers finished in. The
+  // writer completes writes in the order they were queued
+  std::atomic<size_t> failures{0};
+  size_t duplicates = 0;
+  OutputWriter writer(threadCount * 4);
+  for (ProgramJob& job : jobs) {
+    const char* stageName = GetBNSHStageName(job.program.stage);
+    ProgramJob& decoded = job.original ? *job.original : job;
+    {
+      std::unique_lock lock{finishedMutex};
+      finishedCondition.wait(lock, [&decoded] { return decoded.finished; });
+    }
+    const bool success = decoded.success;
+    std::vector<OutputWriter::Output> outputs;
+    for (size_t ii = 0; success && ii < decoded.results.size(); ++ii) {
+      DecodeOutput& result = decoded.results[ii];
+      const std::string& variantSuffix = options.variants[ii].suffix;
+      const std::string suffix =
+        fmt::format(".{}.{}{}", job.program.variation, stageName, variantSuffix);
+      if (job.original) {
+        // reference the spirv of the original, written next to this json
+        std::string json = result.json;
+        if (options.outputSPIRV.size()) {
+          const std::string originalSuffix = fmt::format(
+            ".{}.{}{}", decoded.program.variation, GetBNSHStageName(decoded.program.stage),
+            variantSuffix);
+          const std::string spirvFile = InsertFileNameSuffix(options.outputSPIRV, originalSuffix);
+          json = GenerateDuplicateJSON(json, std::filesystem::path(spirvFile).filename().string());
+        }
+        if (options.outputJSON.size()) {
+          OutputWriter::Output& output = outputs.emplace_back();
+          output.jsonFile = InsertFileNameSuffix(options.outputJSON, suffix);
+          output.output.json = std::move(json);
+        }
+        continue;
+      }
+      OutputWriter::Output& output = outputs.emplace_back();
+      if (options.outputJSON.size()) {
+        output.jsonFile = InsertFileNameSuffix(options.outputJSON, suffix);
+      }
+      if (options.outputSPIRV.size()) {
+        output.spirvFile = InsertFileNameSuffix(options.outputSPIRV, suffix);
+      }
+      // duplicates come later in variation order and only still need the json
+      output.output.spirv = std::move(result.spirv);
+      output.output.json = options.dedup ? result.json : std::move(result.json);
+    }
+    if (job.original) ++duplicates;
+    writer.Write(std::move(outputs), [&, success, stageName](bool written) {
+      if (!(success && written)) ++failures;
+      fprintf(success && written ? stdout : stderr, "%s variation %u %s%s\n",
+              success && written ? "[OK]" : "[FAILED]", job.program.variation, stageName,
+              job.original ? " (duplicate)" : "");
+    });
+  }
+  writer.Finish();
+  for (auto& thread : threads) thread.join();
+
+  fprintf(stdout, "Decoded %zu of %zu shader programs using %u threads\n", jobs.size() - failures.load(),
+          jobs.size(), threadCount);
+  if (options.dedup) fprintf(stdout, "%zu shader programs were duplicates\n", duplicates);
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bnsh_cli/decoder.h"
+
+class DecodeCache;
+
+typedef struct ProgramsOptions {
+  // bnsh file holding any number of variations and stages
+  std::string input;
+  // outputs get the variation and stage inserted in front of the extension
+  std::string outputJSON;
+  std::string outputSPIRV;
+  // number of worker threads, 0 picks the hardware concurrency
+  uint32_t jobs = 0;
+  std::vector<DecodeVariant> variants{};
+  // decodes the vertex and fragment program of each variation together and prunes the varyings
+  // only one of them uses
+  bool linkVaryings = false;
+  // decodes programs with identical bytecode and reflection only once, the others reference the
+  // spirv of the first one
+  bool dedup = false;
+  const DecodeCache* cache = nullptr;
+} ProgramsOptions;
+
+// decodes every stage program of every variation of a bnsh file concurrently and writes the
+// results in variation order, returns the process exit code
+int RunAllPrograms(const ProgramsOptions& options);
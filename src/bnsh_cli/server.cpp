@@ -0,0 +1,169 @@
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "bnsh_cli/bnsh_file.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/decoder.h"
+#include "bnsh_cli/server.h"
+#include "common/assert.h"
+
+namespace {
+
+using VideoCommon::Shader::ProgramCode;
+
+u32 ReadU32(const u8* data) {
+  u32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void WriteU32(std::vector<u8>& out, u32 value) {
+  const size_t offset = out.size();
+  out.resize(offset + sizeof(value));
+  std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+std::vector<u8> BuildResponse(u32 status, const std::vector<u32>& spirv, const std::string& json) {
+  const u32 spirvSize = static_cast<u32>(spirv.size() * sizeof(u32));
+  std::vector<u8> response;
+  response.reserve(3 * sizeof(u32) + spirvSize + json.size());
+  WriteU32(response, status);
+  WriteU32(response, spirvSize);
+  WriteU32(response, static_cast<u32>(json.size()));
+  response.insert(response.end(), reinterpret_cast<const u8*>(spirv.data()),
+                  reinterpret_cast<const u8*>(spirv.data()) + spirvSize);
+  response.insert(response.end(), json.begin(), json.end());
+  return response;
+}
+
+std::vector<u8> BuildErrorResponse(std::string_view message) {
+  std::string json = "{\"error\":";
+  AppendJSONString(json, message);
+  json += "}";
+  return BuildResponse(1, {}, json);
+}
+
+bool ReadExact(FILE* file, void* data, size_t size) {
+  return fread(data, 1, size, file) == size;
+}
+
+bool WriteExact(FILE* file, const void* data, size_t size) {
+  return fwrite(data, 1, size, file) == size;
+}
+
+// decodes a request frame into a response frame
+std::vector<u8> DecodeFrame(const std::vector<u8>& frame, const DecodeCache* cache) {
+  if (frame.size() < 2 * sizeof(u32)) return BuildErrorResponse("Truncated request");
+
+  const u32 baseBindingIndex = ReadU32(frame.data());
+  // bindings are numbered in a byte, larger indices would wrap around
+  if (baseBindingIndex > UINT8_MAX) return BuildErrorResponse("Base binding index exceeds 255");
+  const u32 varyingCount = ReadU32(frame.data() + sizeof(u32));
+  const size_t codeOffset = 2 * sizeof(u32) + static_cast<size_t>(varyingCount);
+  if (codeOffset > frame.size()) return BuildErrorResponse("Truncated request");
+
+  std::vector<u8> customInputVaryings(frame.begin() + 2 * sizeof(u32),
+                                      frame.begin() + codeOffset);
+
+  // copy into u64 aligned storage, the frame payload has no alignment guarantees
+  const u8* codeData = frame.data() + codeOffset;
+  const size_t codeSize = frame.size() - codeOffset;
+  u32 magic = codeSize >= sizeof(u32) ? ReadU32(codeData) : 0;
+  std::optional<ProgramCode> code;
+  std::optional<BNSHStageReflection> reflection;
+  if (magic == BNSH_MAGIC || magic == NVN_BYTECODE_MAGIC) {
+    // the same program and reflection as decoding the file with the cli, so both share the cache
+    std::optional<BNSHProgramCode> program;
+    code = ExtractProgramCode(codeData, codeSize, "request", false, &program);
+    if (program && program->reflectionOffset) {
+      BNSHStageReflection stageReflection{};
+      std::string error;
+      if (ReadBNSHStageReflection(codeData, codeSize, *program, stageReflection, error)) {
+        reflection = stageReflection;
+      }
+    }
+  } else {
+    code = ProgramCode((codeSize + sizeof(u64) - 1) / sizeof(u64));
+    std::memcpy(code->data(), codeData, codeSize);
+  }
+  if (!code || code->size() * sizeof(u64) < MIN_PROGRAM_SIZE) {
+    return BuildErrorResponse("Unsupported data");
+  }
+
+  // the reflection views the frame, which outlives the decode
+  DecodeOutput result = DecodeShaderCached(cache, *code, static_cast<uint8_t>(baseBindingIndex),
+                                           customInputVaryings,
+                                           reflection ? &*reflection : nullptr);
+
+  return BuildResponse(0, result.spirv, result.json);
+}
+
+}  // namespace
+
+std::vector<u8> HandleDecodeFrame(const std::vector<u8>& frame, const DecodeCache* cache) {
+  // a frame the decoder rejects only fails its own request, not the server and its other clients
+  try {
+    Common::ScopedRecoverableAsserts recoverableAsserts;
+    return DecodeFrame(frame, cache);
+  } catch (const Common::AssertionFailure&) {
+    return BuildErrorResponse("Decoding failed");
+  } catch (const std::bad_alloc&) {
+    return BuildErrorResponse("Out of memory");
+  } catch (const std::exception&) {
+    return BuildErrorResponse("Decoding failed");
+  }
+}
+
+int RunStdioServer(const DecodeCache* cache) {
+  // keep the response stream private, so that diagnostics printed by the decoder end up on stderr
+#ifdef _WIN32
+  _setmode(_fileno(stdin), _O_BINARY);
+  FILE* out = _fdopen(_dup(_fileno(stdout)), "wb");
+  _dup2(_fileno(stderr), _fileno(stdout));
+#else
+  FILE* out = fdopen(dup(STDOUT_FILENO), "wb");
+  dup2(STDERR_FILENO, STDOUT_FILENO);
+#endif
+  if (!out) {
+    fprintf(stderr, "Failed to open response stream\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<u8> frame;
+  for (;;) {
+    u32 frameSize;
+    // stdin got closed between frames, regular shutdown
+    if (!ReadExact(stdin, &frameSize, sizeof(frameSize))) break;
+    if (frameSize > MAX_FRAME_SIZE) {
+      fprintf(stderr, "Request frame exceeds maximum frame size\n");
+      return EXIT_FAILURE;
+    }
+    frame.resize(frameSize);
+    if (!ReadExact(stdin, frame.data(), frameSize)) {
+      fprintf(stderr, "Truncated request frame\n");
+      return EXIT_FAILURE;
+    }
+
+    std::vector<u8> response = HandleDecodeFrame(frame, cache);
+
+    const u32 responseSize = static_cast<u32>(response.size());
+    if (!WriteExact(out, &responseSize, sizeof(responseSize)) ||
+        !WriteExact(out, response.data(), response.size()) || fflush(out) != 0) {
+      fprintf(stderr, "Failed to write response frame\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+class DecodeCache;
+
+// Decode requests and responses are exchanged as frames, each prefixed with its little endian
+// u32 byte size.
+//
+// Request frame:
+//   u32 base_binding_index     at most 255
+//   u32 input_varying_count
+//   u8  input_varyings[input_varying_count]
+//   u8  code[]                 raw bytecode starting at the SPH, or a whole BNSH file
+//
+// Response frame:
+//   u32 status                 0 on success
+//   u32 spirv_size             in bytes
+//   u32 json_size              in bytes
+//   u8  spirv[spirv_size]
+//   u8  json[json_size]        reflection json, or {"error":"..."} on failure
+
+// maximum accepted request frame size
+constexpr u32 MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+// decodes a single request frame into a response frame
+std::vector<u8> HandleDecodeFrame(const std::vector<u8>& frame, const DecodeCache* cache);
+
+// serves decode requests from stdin until it's closed, returns the process exit code
+int RunStdioServer(const DecodeCache* cache);
+
+typedef struct SocketServerOptions {
+  // unix domain socket path to listen on
+  std::string path;
+  // number of decode threads, 0 picks the hardware concurrency
+  uint32_t jobs = 0;
+  // maximum number of queued requests before clients get throttled, 0 picks 4 per thread. Also
+  // bounds the unanswered requests of each client
+  uint32_t queueSize = 0;
+  // maximum number of connected clients, further ones wait until one disconnects. 0 picks 64
+  uint32_t maxConnections = 0;
+  // optional decode result cache shared by all decode threads
+  const DecodeCache* cache = nullptr;
+} SocketServerOptions;
+
+// serves decode requests of many concurrent local clients until SIGINT or SIGTERM
+int RunSocketServer(const SocketServerOptions& options);
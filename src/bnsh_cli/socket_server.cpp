@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "bnsh_cli/server.h"
+#include "common/bounded_queue.h"
+
+#ifdef _WIN32
+
+int RunSocketServer(const SocketServerOptions& options) {
+  fprintf(stderr, "Unix domain socket server isn't supported on this platform\n");
+  return EXIT_FAILURE;
+}
+
+#else
+
+namespace {
+
+// drop clients which stop reading their responses, only their own writer thread waits for them
+constexpr time_t SEND_TIMEOUT_SECONDS = 30;
+
+std::atomic<bool> shutdownRequested{false};
+
+void HandleShutdownSignal(int) {
+  shutdownRequested = true;
+}
+
+bool ReadExact(int fd, void* data, size_t size) {
+  u8* bytes = static_cast<u8*>(data);
+  while (size) {
+    ssize_t count = recv(fd, bytes, size, 0);
+    if (count <= 0) return false;
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+bool WriteExact(int fd, const void* data, size_t size) {
+  const u8* bytes = static_cast<const u8*>(data);
+  while (size) {
+    ssize_t count = send(fd, bytes, size, 0);
+    if (count <= 0) return false;
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+struct Connection {
+  explicit Connection(int fd) : fd{fd} {}
+  ~Connection() { close(fd); }
+
+  const int fd;
+  std::mutex mutex;
+  std::condition_variable changed;
+  // responses are written in request order, out of order completions wait here
+  std::map<u64, std::vector<u8>> completed;
+  u64 nextResponse = 0;
+  // number of requests once the reader is done
+  std::optional<u64> requestCount;
+  bool broken = false;
+
+  // called by the decode workers, which only hand the response over and never block on the client
+  void Complete(u64 sequence, std::vector<u8> response) {
+    std::lock_guard lock{mutex};
+    completed.emplace(sequence, std::move(response));
+    changed.notify_all();
+  }
+
+  // waits until fewer than limit of the requests read so far are unanswered, so a client which
+  // doesn't read its responses can't pile them up. Returns false if the connection broke
+  bool WaitForCapacity(u64 requests, u64 limit) {
+    std::unique_lock lock{mutex};
+    changed.wait(lock, [&] { return broken || requests - nextResponse < limit; });
+    return !broken;
+  }
+
+  void FinishReading(u64 requests) {
+    std::lock_guard lock{mutex};
+    requestCount = requests;
+    changed.notify_all();
+  }
+
+  // writer thread of the connection, answers every request read in order
+  void WriteResponses() {
+    std::unique_lock lock{mutex};
+    for (;;) {
+      changed.wait(lock, [this] {
+        return completed.count(nextResponse) != 0 || requestCount == nextResponse;
+      });
+      auto it = completed.find(nextResponse);
+      if (it == completed.end()) return;
+      const std::vector<u8> response = std::move(it->second);
+      completed.erase(it);
+      lock.unlock();
+      const u32 responseSize = static_cast<u32>(response.size());
+      const bool written = WriteExact(fd, &responseSize, sizeof(responseSize)) &&
+                           WriteExact(fd, response.data(), response.size());
+      lock.lock();
+      ++nextResponse;
+      changed.notify_all();
+      if (!written) {
+        // unblocks the reader, responses of its remaining jobs are dropped with the connection
+        broken = true;
+        shutdown(fd, SHUT_RDWR);
+        return;
+      }
+    }
+  }
+};
+
+typedef struct Job {
+  std::shared_ptr<Connection> connection;
+  u64 sequence;
+  std::vector<u8> frame;
+} Job;
+
+// tracks detached connection readers, so that shutdown can wait for them and accepting can be
+// paused at the connection limit
+struct ReaderCount {
+  std::mutex mutex;
+  std::condition_variable changed;
+  u32 count = 0;
+};
+
+void ServeConnection(std::shared_ptr<Connection> connection, Common::BoundedQueue<Job>& queue,
+                     u64 pendingLimit, ReaderCount& readers) {
+  std::thread writer(&Connection::WriteResponses, connection.get());
+  u64 sequence = 0;
+  for (;; ++sequence) {
+    if (!connection->WaitForCapacity(sequence, pendingLimit)) break;
+    u32 frameSize;
+    if (!ReadExact(connection->fd, &frameSize, sizeof(frameSize))) break;
+    if (frameSize > MAX_FRAME_SIZE) {
+      fprintf(stderr, "Request frame exceeds maximum frame size, dropping client\n");
+      break;
+    }
+    std::vector<u8> frame(frameSize);
+    if (!ReadExact(connection->fd, frame.data(), frameSize)) break;
+    // blocks while the pool is saturated, so the client's writes stall in turn
+    if (!queue.Push(Job{ connection, sequence, std::move(frame) })) break;
+  }
+  shutdown(connection->fd, SHUT_RD);
+  connection->FinishReading(sequence);
+  writer.join();
+  connection.reset();
+
+  std::lock_guard lock{readers.mutex};
+  --readers.count;
+  readers.changed.notify_all();
+}
+
+}  // namespace
+
+int RunSocketServer(const SocketServerOptions& options) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (options.path.size() >= sizeof(address.sun_path)) {
+    fprintf(stderr, "%s: Socket path is too long\n", options.path.c_str());
+    return EXIT_FAILURE;
+  }
+  std::strncpy(address.sun_path, options.path.c_str(), sizeof(address.sun_path) - 1);
+
+  int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    fprintf(stderr, "Failed to create socket: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+  }
+  // remove a stale socket of a previous run
+  unlink(options.path.c_str());
+  if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(listenFd, SOMAXCONN) != 0) {
+    fprintf(stderr, "%s: Failed to listen: %s\n", options.path.c_str(), strerror(errno));
+    close(listenFd);
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+  std::signal(SIGINT, HandleShutdownSignal);
+  std::signal(SIGTERM, HandleShutdownSignal);
+
+  const uint32_t jobs = std::max(1u, options.jobs ? options.jobs : std::thread::hardware_concurrency());
+  const uint32_t queueSize = options.queueSize ? options.queueSize : jobs * 4;
+  Common::BoundedQueue<Job> queue(queueSize);
+
+  std::vector<std::thread> workers;
+  for (uint32_t ii = 0; ii < jobs; ++ii) {
+    workers.emplace_back([&queue, cache = options.cache]() {
+      while (std::optional<Job> job = queue.Pop()) {
+        job->connection->Complete(job->sequence, HandleDecodeFrame(job->frame, cache));
+      }
+    });
+  }
+
+  fprintf(stdout, "Listening on %s using %u threads\n", options.path.c_str(), jobs);
+  fflush(stdout);
+
+  const uint32_t maxConnections = options.maxConnections ? options.maxConnections : 64;
+  std::mutex connectionsMutex;
+  std::vector<std::weak_ptr<Connection>> connections;
+  ReaderCount readers;
+  while (!shutdownRequested) {
+    {
+      // further clients wait in the listen backlog until a connection closes
+      std::unique_lock lock{readers.mutex};
+      if (!readers.changed.wait_for(lock, std::chrono::milliseconds(250),
+                                    [&] { return readers.count < maxConnections; })) {
+        continue;
+      }
+    }
+    // wake up periodically to notice shutdown requests
+    pollfd pfd{ listenFd, POLLIN, 0 };
+    if (poll(&pfd, 1, 250) <= 0) continue;
+    int clientFd = accept(listenFd, nullptr, nullptr);
+    if (clientFd < 0) continue;
+
+    timeval timeout{ SEND_TIMEOUT_SECONDS, 0 };
+    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    auto connection = std::make_shared<Connection>(clientFd);
+    {
+      std::lock_guard lock{connectionsMutex};
+      connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                       [](const auto& weak) { return weak.expired(); }),
+                        connections.end());
+      connections.push_back(connection);
+    }
+    {
+      std::lock_guard lock{readers.mutex};
+      ++readers.count;
+    }
+    std::thread(ServeConnection, std::move(connection), std::ref(queue), u64{queueSize},
+                std::ref(readers)).detach();
+  }
+
+  fprintf(stdout, "Shutting down\n");
+  close(listenFd);
+  unlink(options.path.c_str());
+  {
+    // stop reading new requests, requests already queued are still answered
+    std::lock_guard lock{connectionsMutex};
+    for (auto& weak : connections) {
+      if (auto connection = weak.lock()) shutdown(connection->fd, SHUT_RD);
+    }
+  }
+  {
+    std::unique_lock lock{readers.mutex};
+    readers.changed.wait(lock, [&readers] { return readers.count == 0; });
+  }
+  queue.Close();
+  for (auto& worker : workers) worker.join();
+
+  return EXIT_SUCCESS;
+}
+
+#endif
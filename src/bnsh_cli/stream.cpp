@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include <fmt/format.h>
+
+#include "bnsh_cli/bnsh_file.h"
+#include "bnsh_cli/cache.h"
+#include "bnsh_cli/output_writer.h"
+#include "bnsh_cli/stream.h"
+#include "common/assert.h"
+#include "common/word_scan.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using VideoCommon::Shader::ProgramCode;
+using VideoCommon::Shader::ProgramCodeView;
+
+constexpr size_t BNSH_HEADER_SIZE = 0x20;
+
+// sliding window over the dump. The buffer starts u64 aligned, but the unread bytes are moved to
+// its front whenever more of the dump is read, so an item has no guaranteed alignment in it
+class StreamWindow {
+public:
+  StreamWindow(std::ifstream& file, size_t capacity)
+    : file{file}, buffer((capacity + sizeof(u64) - 1) / sizeof(u64)) {}
+
+  const u8* Data() const { return reinterpret_cast<const u8*>(buffer.data()) + begin; }
+  size_t Available() const { return end - begin; }
+  size_t Capacity() const { return buffer.size() * sizeof(u64); }
+  // offset of Data() in the dump
+  u64 Position() const { return position; }
+  bool AtEnd() const { return eof; }
+
+  // reads until at least size bytes are available or the dump ends, returns whether they are
+  bool Fill(size_t size) {
+    if (Available() >= size) return true;
+    u8* bytes = reinterpret_cast<u8*>(buffer.data());
+    std::memmove(bytes, bytes + begin, Available());
+    end -= begin;
+    begin = 0;
+    while (!eof && end < Capacity()) {
+      file.read(reinterpret_cast<char*>(bytes + end), static_cast<std::streamsize>(Capacity() - end));
+      end += static_cast<size_t>(file.gcount());
+      eof = !file;
+    }
+    return Available() >= size;
+  }
+
+  void Consume(size_t size) {
+    begin += size;
+    position += size;
+  }
+
+  // consumes size bytes, reading past the ones not buffered. Returns false if the dump ends first
+  bool Skip(u64 size) {
+    const size_t buffered = static_cast<size_t>(std::min<u64>(size, Available()));
+    Consume(buffered);
+    size -= buffered;
+    if (size == 0) return true;
+    file.ignore(static_cast<std::streamsize>(size));
+    const u64 skipped = static_cast<u64>(file.gcount());
+    position += skipped;
+    eof = !file;
+    return skipped == size;
+  }
+
+private:
+  std::ifstream& file;
+  ProgramCode buffer;
+  size_t begin = 0;
+  size_t end = 0;
+  u64 position = 0;
+  bool eof = false;
+};
+
+u32 ReadU32(const u8* data) {
+  u32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// finds the next bnsh file or raw bytecode section at a 4 byte step of the dump
+std::optional<size_t> FindItem(const u8* data, size_t size, size_t start) {
+  if (start > size) return std::nullopt;
+  const size_t count = (size - start) / sizeof(u32);
+  const size_t index = Common::FindWord32(data + start, count, BNSH_MAGIC, NVN_BYTECODE_MAGIC);
+  if (index == count) return std::nullopt;
+  return start + index * sizeof(u32);
+}
+
+class StreamDecoder {
+public:
+  StreamDecoder(const StreamOptions& options, std::string outputBase)
+    : options{options}, outputBase{std::move(outputBase)}, writer(4) {}
+
+  // decodes every program of a bnsh file held in the window
+  void DecodeContainer(const u8* data, size_t size, size_t item) {
+    std::vector<BNSHProgramCode> programs;
+    std::string error;
+    if (!ReadBNSHProgramCodes(data, size, programs, error)) {
+      fprintf(stderr, "[FAILED] item %zu: %s\n", item, error.c_str());
+      ++failures;
+      return;
+    }
+    for (const BNSHProgramCode& program : programs) {
+      std::optional<BNSHStageReflection> reflection;
+      if (program.reflectionOffset) {
+        BNSHStageReflection stageReflection{};
+        if (ReadBNSHStageReflection(data, size, program, stageReflection, error)) {
+          reflection = stageReflection;
+        }
+      }
+      const std::string name = fmt::format("{}.{}.{}", item, program.variation,
+                                           GetBNSHStageName(program.stage));
+      Decode(data + program.offset, program.size, reflection ? &*reflection : nullptr, name);
+    }
+  }
+
+  // decodes a raw bytecode section held in the window
+  void DecodeRaw(const u8* data, size_t size, size_t item) {
+    Decode(data + NVN_BYTECODE_HEADER_SIZE, size - NVN_BYTECODE_HEADER_SIZE, nullptr,
+           std::to_string(item));
+  }
+
+  // waits for the queued outputs
+  void Finish() {
+    writer.Finish();
+  }
+
+  size_t Programs() const { return programs; }
+  // only complete after Finish
+  size_t Failures() const { return failures; }
+
+private:
+  void Decode(const u8* data, size_t size, const BNSHStageReflection* reflection,
+              const std::string& name) {
+    ++programs;
+    // programs at unaligned positions of the dump are copied
+    ProgramCodeView code;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(u64) == 0) {
+      code = ProgramCodeView(reinterpret_cast<const u64*>(data), size / sizeof(u64));
+    } else {
+      scratch.assign((size + sizeof(u64) - 1) / sizeof(u64), 0);
+      std::memcpy(scratch.data(), data, size);
+      code = scratch;
+    }
+
+    bool success = size >= MIN_PROGRAM_SIZE;
+    std::vector<DecodeOutput> results;
+    // a program the decoder rejects only fails itself, not the rest of the dump
+    try {
+      Common::ScopedRecoverableAsserts recoverableAsserts;
+      if (success) {
+        results = DecodeShaderVariantsCached(options.cache, code, options.variants, reflection);
+      }
+    } catch (const Common::AssertionFailure&) {
+      success = false;
+    } catch (const std::exception& e) {
+      fprintf(stderr, "%s: %s\n", name.c_str(), e.what());
+      success = false;
+    }
+    std::vector<OutputWriter::Output> outputs(results.size());
+    for (size_t ii = 0; ii < results.size(); ++ii) {
+      const std::string outputName = outputBase + "." + name + options.variants[ii].suffix;
+      outputs[ii].jsonFile = outputName + ".json";
+      outputs[ii].spirvFile = outputName + ".spv";
+      outputs[ii].output = std::move(results[ii]);
+    }
+    // a program is reported once its outputs are written
+    writer.Write(std::move(outputs), [this, success, name](bool written) {
+      if (!(success && written)) ++failures;
+      fprintf(success && written ? stdout : stderr, "%s %s\n",
+              success && written ? "[OK]" : "[FAILED]", name.c_str());
+    });
+  }
+
+  const StreamOptions& options;
+  std::string outputBase;
+  ProgramCode scratch;
+  size_t programs = 0;
+  // counted by the writer thread
+  std::atomic<size_t> failures{0};
+  // declared last so it finishes before the members its reports use are destroyed
+  OutputWriter writer;
+};
+
+}  // namespace
+
+int RunStream(const StreamOptions& options) {
+  std::ifstream file(options.input, std::ios::binary);
+  if (!file.is_open()) {
+    fprintf(stderr, "%s: Failed to open file!\n", options.input.c_str());
+    return EXIT_FAILURE;
+  }
+  std::error_code ec;
+  fs::create_directories(options.outputDir, ec);
+  const std::string outputBase =
+    (fs::path(options.outputDir) / fs::path(options.input).filename()).string();
+
+  StreamWindow window(file, std::max<size_t>(options.windowSize, BNSH_HEADER_SIZE));
+  StreamDecoder decoder(options, outputBase);
+  size_t items = 0;
+  size_t skippedItems = 0;
+
+  while (window.Fill(sizeof(u32))) {
+    std::optional<size_t> start = FindItem(window.Data(), window.Available(), 0);
+    if (!start) {
+      // keep the bytes which don't fill a whole step
+      window.Consume(window.Available() / sizeof(u32) * sizeof(u32));
+      if (window.AtEnd()) break;
+      continue;
+    }
+    window.Consume(*start);
+    const size_t item = items++;
+
+    if (ReadU32(window.Data()) == BNSH_MAGIC) {
+      // containers are delimited by the file size of their header
+      const u32 fileSize = window.Fill(BNSH_HEADER_SIZE) ? ReadU32(window.Data() + 0x1C) : 0;
+      if (fileSize < BNSH_HEADER_SIZE) {
+        fprintf(stderr, "[FAILED] item %zu: Invalid BNSH header at 0x%llX\n", item,
+                static_cast<unsigned long long>(window.Position()));
+        ++skippedItems;
+        window.Consume(std::min(window.Available(), sizeof(u32)));
+        continue;
+      }
+      if (fileSize > window.Capacity()) {
+        fprintf(stderr, "[FAILED] item %zu: BNSH file of 0x%X bytes exceeds the window\n", item,
+                fileSize);
+        ++skippedItems;
+        if (!window.Skip(fileSize)) break;
+        continue;
+      }
+      if (!window.Fill(fileSize)) {
+        fprintf(stderr, "[FAILED] item %zu: Truncated BNSH file\n", item);
+        ++skippedItems;
+        break;
+      }
+      decoder.DecodeContainer(window.Data(), fileSize, item);
+      window.Consume(fileSize);
+      continue;
+    }
+
+    // raw bytecode sections carry no size, they end where the next item starts
+    std::optional<size_t> next = FindItem(window.Data(), window.Available(), sizeof(u32));
+    if (!next && !window.AtEnd()) {
+      window.Fill(window.Capacity());
+      next = FindItem(window.Data(), window.Available(), sizeof(u32));
+      if (!next && !window.AtEnd()) {
+        // the section goes on past a full window, skip to the next item instead of cutting it
+        fprintf(stderr, "[FAILED] item %zu: Bytecode section exceeds the window\n", item);
+        ++skippedItems;
+        window.Consume(window.Available() / sizeof(u32) * sizeof(u32));
+        continue;
+      }
+    }
+    const size_t size = next ? *next : window.Available();
+    if (size < NVN_BYTECODE_HEADER_SIZE) {
+      fprintf(stderr, "[FAILED] item %zu: Truncated bytecode section\n", item);
+      ++skippedItems;
+      window.Consume(size);
+      continue;
+    }
+    decoder.DecodeRaw(window.Data(), size, item);
+    window.Consume(size);
+  }
+
+  decoder.Finish();
+
+  fprintf(stdout, "Decoded %zu of %zu shader programs from %zu items\n",
+          decoder.Programs() - decoder.Failures(), decoder.Programs(), items);
+
+  return decoder.Failures() || skippedItems ? EXIT_FAILURE : EXIT_SUCCESS;
+}
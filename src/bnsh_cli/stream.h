@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bnsh_cli/decoder.h"
+
+class DecodeCache;
+
+typedef struct StreamOptions {
+  // dump of bnsh files and raw bytecode sections stored back to back
+  std::string input;
+  // outputs are named after the dump, the index of the item in it and the program
+  std::string outputDir;
+  // bytes of the dump held in memory at once, bounds the size of a single item
+  size_t windowSize = 64 * 1024 * 1024;
+  std::vector<DecodeVariant> variants{};
+  const DecodeCache* cache = nullptr;
+} StreamOptions;
+
+// reads a dump through a fixed size window and decodes every program found in it as it arrives,
+// returns the process exit code
+int RunStream(const StreamOptions& options);
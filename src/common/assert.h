@@ -5,9 +5,42 @@
 #pragma once
 
 #include <cstdlib>
+#include <stdexcept>
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
 
+namespace Common {
+
+/// Thrown by failed asserts instead of terminating, see ScopedRecoverableAsserts
+class AssertionFailure : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace Detail {
+inline thread_local bool recoverable_asserts = false;
+} // namespace Detail
+
+/// Makes failed asserts of the calling thread throw AssertionFailure while in scope. Embedders use
+/// this to report malformed input as an error instead of losing the whole process.
+class ScopedRecoverableAsserts {
+public:
+    ScopedRecoverableAsserts() : previous{Detail::recoverable_asserts} {
+        Detail::recoverable_asserts = true;
+    }
+    ~ScopedRecoverableAsserts() {
+        Detail::recoverable_asserts = previous;
+    }
+
+    ScopedRecoverableAsserts(const ScopedRecoverableAsserts&) = delete;
+    ScopedRecoverableAsserts& operator=(const ScopedRecoverableAsserts&) = delete;
+
+private:
+    bool previous;
+};
+
+} // namespace Common
+
 // For asserts we'd like to keep all the junk executed when an assert happens away from the
 // important code in the function. One way of doing this is to put all the relevant code inside a
 // lambda and force the compiler to not inline it. Unfortunately, MSVC seems to have no syntax to
@@ -23,6 +56,9 @@ __declspec(noinline, noreturn)
 #endif
     static void assert_noinline_call(const Fn& fn) {
     fn();
+    if (Common::Detail::recoverable_asserts) {
+        throw Common::AssertionFailure("Assertion failed");
+    }
     Crash();
     exit(1); // Keeps GCC's mouth shut about this actually returning
 }
@@ -0,0 +1,72 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace Common {
+
+/**
+ * A multi-producer multi-consumer queue holding at most a fixed number of elements. Producers
+ * block while the queue is full, which propagates backpressure to whoever feeds the queue.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity{capacity > 0 ? capacity : 1} {}
+
+    /**
+     * Pushes an element, waiting for free space if the queue is full.
+     * @returns false if the queue got closed, in which case the element is dropped.
+     */
+    bool Push(T t) {
+        std::unique_lock lock{mutex};
+        not_full.wait(lock, [this] { return closed || queue.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        queue.push_back(std::move(t));
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * Pops an element, waiting for one to arrive if the queue is empty.
+     * @returns std::nullopt once the queue is closed and drained.
+     */
+    std::optional<T> Pop() {
+        std::unique_lock lock{mutex};
+        not_empty.wait(lock, [this] { return closed || !queue.empty(); });
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        T t = std::move(queue.front());
+        queue.pop_front();
+        not_full.notify_one();
+        return t;
+    }
+
+    /// Wakes up all waiters, pending elements can still be popped.
+    void Close() {
+        std::scoped_lock lock{mutex};
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    const std::size_t capacity;
+    std::deque<T> queue;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    bool closed = false;
+};
+
+} // namespace Common
@@ -0,0 +1,113 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+#ifdef _WIN32
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // The mapping keeps its own reference to the file
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_size.QuadPart);
+    mapping_handle = mapping;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        CloseHandle(mapping_handle);
+    }
+    data = nullptr;
+    size = 0;
+    mapping_handle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing its descriptor
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr) {
+        munmap(const_cast<u8*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,53 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "common/common_types.h"
+
+namespace Common {
+
+/// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Maps the specified file into memory.
+     * @returns false if the file couldn't be mapped, e.g. because it's empty or not a regular file.
+     */
+    bool Open(const std::string& path);
+
+    /// Unmaps the file, if any.
+    void Close();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* Data() const {
+        return data;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Common
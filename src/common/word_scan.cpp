@@ -0,0 +1,55 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "common/bit_util.h"
+#include "common/word_scan.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WORD_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Common {
+
+std::size_t FindWord32(const void* data, std::size_t count, u32 first, u32 second) {
+    std::size_t index = 0;
+
+#if defined(WORD_SCAN_SSE2)
+    const auto* bytes = static_cast<const u8*>(data);
+    // Four vectors are compared per iteration, the match is located in their combined mask
+    const __m128i first_vector = _mm_set1_epi32(static_cast<s32>(first));
+    const __m128i second_vector = _mm_set1_epi32(static_cast<s32>(second));
+    for (; index + 16 <= count; index += 16) {
+        u32 found = 0;
+        for (u32 i = 0; i < 4; ++i) {
+            const __m128i words = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(bytes + (index + i * 4) * sizeof(u32)));
+            const __m128i equal = _mm_or_si128(_mm_cmpeq_epi32(words, first_vector),
+                                               _mm_cmpeq_epi32(words, second_vector));
+            found |= static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(equal))) << (i * 4);
+        }
+        if (found != 0) {
+            return index + CountTrailingZeroes32(found);
+        }
+    }
+#endif
+
+    const auto* tail = static_cast<const u8*>(data) + index * sizeof(u32);
+    return index + FindWord32Scalar(tail, count - index, first, second);
+}
+
+std::size_t FindWord32Scalar(const void* data, std::size_t count, u32 first, u32 second) {
+    const auto* bytes = static_cast<const u8*>(data);
+    for (std::size_t index = 0; index < count; ++index) {
+        u32 word;
+        std::memcpy(&word, bytes + index * sizeof(u32), sizeof(word));
+        if (word == first || word == second) {
+            return index;
+        }
+    }
+    return count;
+}
+
+} // namespace Common
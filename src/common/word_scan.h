@@ -0,0 +1,24 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Finds the first 32-bit word equal to either of two values. Vectorized with SSE2 on x86,
+ * scalar on other targets.
+ * @param data Words to scan, they don't have to be aligned
+ * @param count Number of words in data
+ * @returns The index of the first matching word, or count if there is none
+ */
+std::size_t FindWord32(const void* data, std::size_t count, u32 first, u32 second);
+
+/// Scalar version of FindWord32, the fallback of targets without SSE2 and the benchmark baseline
+std::size_t FindWord32Scalar(const void* data, std::size_t count, u32 first, u32 second);
+
+} // namespace Common
@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "bnsh_cli/bnsh.h"
+
+// looks up the entries of the bundle written from bundle.txt through the public interface, a
+// runtime would map the file instead of reading it
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* what) {
+  if (condition) return;
+  fprintf(stderr, "[FAILED] %s\n", what);
+  ++failures;
+}
+
+bnsh_status Find(const std::vector<uint64_t>& bundle, size_t size, const std::string& name,
+                 bnsh_bundle_entry& entry) {
+  return bnsh_bundle_find(bundle.data(), size, name.data(), name.size(), &entry);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: bundle_test <bundle> <expected spirv of frag.bnsh_fsh>\n");
+    return EXIT_FAILURE;
+  }
+  std::ifstream bundleFile(argv[1], std::ios::binary);
+  std::ifstream spirvFile(argv[2], std::ios::binary);
+  if (!bundleFile.is_open() || !spirvFile.is_open()) {
+    fprintf(stderr, "Failed to open the test files\n");
+    return EXIT_FAILURE;
+  }
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(bundleFile)), {});
+  const std::vector<char> expectedSpirv((std::istreambuf_iterator<char>(spirvFile)), {});
+  // u64 storage keeps the bundle aligned like a mapping would
+  std::vector<uint64_t> bundle((bytes.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  std::memcpy(bundle.data(), bytes.data(), bytes.size());
+
+  bnsh_bundle_entry frag{};
+  Check(Find(bundle, bytes.size(), "frag.bnsh_fsh", frag) == BNSH_OK, "hit");
+  Check(frag.spirv_size * sizeof(uint32_t) == expectedSpirv.size() &&
+          std::memcmp(frag.spirv, expectedSpirv.data(), expectedSpirv.size()) == 0,
+        "hit spirv");
+  Check(frag.json_size > 0 && frag.json[0] == '{', "hit json");
+
+  // struct_frag.bnsh_fsh holds the same program and was deduplicated
+  bnsh_bundle_entry duplicate{};
+  Check(Find(bundle, bytes.size(), "struct_frag.bnsh_fsh", duplicate) == BNSH_OK, "duplicate");
+  Check(duplicate.spirv == frag.spirv && duplicate.spirv_size == frag.spirv_size &&
+          duplicate.json == frag.json && duplicate.json_size == frag.json_size,
+        "duplicate shares the blobs of the first occurrence");
+
+  bnsh_bundle_entry refl{};
+  Check(Find(bundle, bytes.size(), "refl.bnsh_fsh", refl) == BNSH_OK && refl.spirv != frag.spirv,
+        "distinct entry");
+
+  bnsh_bundle_entry missing{};
+  Check(Find(bundle, bytes.size(), "missing.bnsh_fsh", missing) == BNSH_ERROR_NOT_FOUND &&
+          !missing.spirv,
+        "miss");
+  Check(Find(bundle, bytes.size(), "frag", missing) == BNSH_ERROR_NOT_FOUND, "name prefix miss");
+
+  Check(Find(bundle, 16, "frag.bnsh_fsh", missing) == BNSH_ERROR_UNSUPPORTED_DATA,
+        "truncated bundle");
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
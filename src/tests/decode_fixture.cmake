@@ -0,0 +1,20 @@
+# runs the CLI with ARGS in WORK_DIR and compares each of OUTPUTS byte for byte with its file in
+# EXPECTED. Lists are passed separated by | since ctest would split them at ;
+string(REPLACE "|" ";" ARGS "${ARGS}")
+string(REPLACE "|" ";" OUTPUTS "${OUTPUTS}")
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+execute_process(COMMAND "${CLI}" ${ARGS} WORKING_DIRECTORY "${WORK_DIR}" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "CLI failed with ${result}")
+endif ()
+
+foreach (output ${OUTPUTS})
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${WORK_DIR}/${output}"
+                    "${EXPECTED}/${output}" RESULT_VARIABLE different)
+    if (different)
+        message(FATAL_ERROR "${output} differs from ${EXPECTED}/${output}")
+    endif ()
+endforeach ()
@@ -2014,6 +2014,10 @@ public:
             return mask;
         }
 
+        constexpr u16 GetExpected() const {
+            return expected;
+        }
+
         constexpr Id GetId() const {
             return id;
         }
@@ -2039,18 +2043,6 @@ public:
         Type type;
     };
 
-    static std::optional<std::reference_wrapper<const Matcher>> Decode(Instruction instr) {
-        static const auto table{GetDecodeTable()};
-
-        const auto matches_instruction = [instr](const auto& matcher) {
-            return matcher.Matches(static_cast<u16>(instr.opcode));
-        };
-
-        auto iter = std::find_if(table.begin(), table.end(), matches_instruction);
-        return iter != table.end() ? std::optional<std::reference_wrapper<const Matcher>>(*iter)
-                                   : std::nullopt;
-    }
-
 private:
     struct Detail {
     private:
@@ -2090,8 +2082,8 @@ private:
         }
     };
 
-    static std::vector<Matcher> GetDecodeTable() {
-        std::vector<Matcher> table = {
+    static constexpr auto GetDecodeTable() {
+        std::array table = {
 #define INST(bitstring, op, type, name) Detail::GetMatcher(bitstring, op, type, name)
             INST("111000110011----", Id::KIL, Type::Flow, "KIL"),
             INST("111000101001----", Id::SSY, Type::Flow, "SSY"),
@@ -2277,14 +2269,78 @@ private:
             INST("0101101100------", Id::XMAD_RR, Type::Xmad, "XMAD_RR"),
         };
 #undef INST
-        std::stable_sort(table.begin(), table.end(), [](const auto& a, const auto& b) {
-            // If a matcher has more bits in its mask it is more specific, so it
-            // should come first.
-            return std::bitset<16>(a.GetMask()).count() > std::bitset<16>(b.GetMask()).count();
-        });
+        // If a matcher has more bits in its mask it is more specific, so it should come first.
+        // Stable insertion sort, std::stable_sort isn't constexpr.
+        const auto mask_bits = [](const Matcher& matcher) {
+            std::size_t count = 0;
+            for (u16 mask = matcher.GetMask(); mask != 0; mask &= static_cast<u16>(mask - 1)) {
+                ++count;
+            }
+            return count;
+        };
+        for (std::size_t i = 1; i < table.size(); ++i) {
+            for (std::size_t j = i; j > 0 && mask_bits(table[j]) > mask_bits(table[j - 1]); --j) {
+                const Matcher swapped = table[j];
+                table[j] = table[j - 1];
+                table[j - 1] = swapped;
+            }
+        }
+
+        return table;
+    }
+
+    /// Maps every 16-bit opcode to one plus the index of the first matcher accepting it in the
+    /// sorted decode table, or zero if none does.
+    template <std::size_t N>
+    static constexpr auto GetLookupTable(const std::array<Matcher, N>& table) {
+        static_assert(N < 0xFF, "Matcher indices must fit in the lookup table");
+        std::array<u8, 0x10000> lookup{};
+        for (std::size_t i = 0; i < N; ++i) {
+            // Visit every opcode the matcher accepts by enumerating the subsets of its free bits
+            const auto free = static_cast<u16>(~table[i].GetMask());
+            u16 bits = free;
+            while (true) {
+                const auto opcode = static_cast<u16>(table[i].GetExpected() | bits);
+                if (lookup[opcode] == 0) {
+                    lookup[opcode] = static_cast<u8>(i + 1);
+                }
+                if (bits == 0) {
+                    break;
+                }
+                bits = static_cast<u16>((bits - 1) & free);
+            }
+        }
+        return lookup;
+    }
 
+    // Defined after the generators, their deduced types aren't known before
+    static const auto& GetTable() {
+        static constexpr auto table{GetDecodeTable()};
         return table;
     }
+
+    static const auto& GetLookup() {
+        static constexpr auto lookup{GetLookupTable(GetDecodeTable())};
+        return lookup;
+    }
+
+public:
+    /// Returns one plus the index of the matcher accepting the instruction, or zero if none does.
+    /// Pass a non-zero index to GetMatcher to get the matcher back.
+    static u8 DecodeIndex(Instruction instr) {
+        return GetLookup()[static_cast<u16>(instr.opcode)];
+    }
+
+    /// Returns the matcher of a non-zero index returned by DecodeIndex.
+    static const Matcher& GetMatcher(u8 index) {
+        return GetTable()[index - 1];
+    }
+
+    static std::optional<std::reference_wrapper<const Matcher>> Decode(Instruction instr) {
+        const u8 index = DecodeIndex(instr);
+        return index != 0 ? std::optional<std::reference_wrapper<const Matcher>>(GetMatcher(index))
+                          : std::nullopt;
+    }
 };
 
 } // namespace Tegra::Shader
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "video_core/engines/shader_bytecode.h"
 
 namespace VideoCommon::Shader {
@@ -18,9 +20,51 @@ enum class CompileDepth : u32 {
 
 std::string CompileDepthAsString(CompileDepth cd);
 
+/// Wall time and work counters of the decoding phases. Times accumulate, scan_flow includes
+/// ast_decompile and decode includes both.
+struct DecodeStats {
+    std::chrono::nanoseconds scan_flow{};
+    std::chrono::nanoseconds ast_decompile{};
+    std::chrono::nanoseconds decode{};
+    std::chrono::nanoseconds post_decode{};
+    std::chrono::nanoseconds spirv_construct{};
+    std::chrono::nanoseconds spirv_assemble{};
+    u32 flow_blocks{};
+    u32 decoded_instructions{};
+    u32 spirv_words{};
+    CompileDepth depth{CompileDepth::BruteForce};
+};
+
+/// Adds the time spent in its scope to a phase of DecodeStats, does nothing without stats
+class ScopedDecodeTimer {
+public:
+    explicit ScopedDecodeTimer(DecodeStats* stats, std::chrono::nanoseconds DecodeStats::*phase)
+        : stats{stats}, phase{phase} {
+        if (stats) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedDecodeTimer() {
+        if (stats) {
+            stats->*phase += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+private:
+    DecodeStats* stats;
+    std::chrono::nanoseconds DecodeStats::*phase;
+    std::chrono::steady_clock::time_point start;
+};
+
 struct CompilerSettings {
     CompileDepth depth{CompileDepth::NoFlowStack};
     bool disable_else_derivation{true};
+    /// Adds a comment node with the disassembly of every decoded instruction, backends which
+    /// drop comments can disable it to skip formatting them
+    bool emit_comments{true};
+    /// Optional, collects timings of the decode when set
+    DecodeStats* stats{};
 };
 
 } // namespace VideoCommon::Shader
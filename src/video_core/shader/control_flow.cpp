@@ -66,10 +66,10 @@ struct BlockInfo {
 };
 
 struct CFGRebuildState {
-    explicit CFGRebuildState(const ProgramCode& program_code, u32 start, Registry& registry)
-        : program_code{program_code}, registry{registry}, start{start} {}
+    explicit CFGRebuildState(const DecodedProgram& program, u32 start, Registry& registry)
+        : program{program}, registry{registry}, start{start} {}
 
-    const ProgramCode& program_code;
+    const DecodedProgram& program;
     Registry& registry;
     u32 start{};
     std::vector<BlockInfo> block_info;
@@ -135,9 +135,9 @@ struct BufferInfo {
 };
 
 std::optional<std::pair<s32, u64>> GetBRXInfo(const CFGRebuildState& state, u32& pos) {
-    const Instruction instr = state.program_code[pos];
-    const auto opcode = OpCode::Decode(instr);
-    if (opcode->get().GetId() != OpCode::Id::BRX) {
+    const Instruction instr = state.program.GetInstruction(pos);
+    const auto opcode = state.program.GetOpcode(pos);
+    if (!opcode || opcode->get().GetId() != OpCode::Id::BRX) {
         return std::nullopt;
     }
     if (instr.brx.constant_buffer != 0) {
@@ -153,11 +153,11 @@ template <typename Result, typename TestCallable, typename PackCallable>
 std::optional<Result> TrackInstruction(const CFGRebuildState& state, u32& pos, TestCallable test,
                                        PackCallable pack) {
     for (; pos >= state.start; --pos) {
-        if (IsSchedInstruction(pos, state.start)) {
+        if (state.program.IsSched(pos)) {
             continue;
         }
-        const Instruction instr = state.program_code[pos];
-        const auto opcode = OpCode::Decode(instr);
+        const Instruction instr = state.program.GetInstruction(pos);
+        const auto opcode = state.program.GetOpcode(pos);
         if (!opcode) {
             continue;
         }
@@ -235,7 +235,7 @@ std::optional<BranchIndirectInfo> TrackBranchIndirectInfo(const CFGRebuildState&
 
 std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address) {
     u32 offset = static_cast<u32>(address);
-    const u32 end_address = static_cast<u32>(state.program_code.size());
+    const u32 end_address = static_cast<u32>(state.program.size());
     ParseInfo parse_info{};
     SingleBranch single_branch{};
 
@@ -260,21 +260,22 @@ std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address)
             single_branch.ignore = true;
             break;
         }
-        if (IsSchedInstruction(offset, state.start)) {
+        if (state.program.IsSched(offset)) {
             offset++;
             continue;
         }
-        const Instruction instr = {state.program_code[offset]};
-        const auto opcode = OpCode::Decode(instr);
-        if (!opcode || opcode->get().GetType() != OpCode::Type::Flow) {
+        if (!state.program.GetOpcode(offset) ||
+            state.program.GetType(offset) != OpCode::Type::Flow) {
             offset++;
             continue;
         }
+        const Instruction instr = state.program.GetInstruction(offset);
 
-        switch (opcode->get().GetId()) {
+        switch (state.program.GetId(offset)) {
         case OpCode::Id::EXIT: {
-            const auto pred_index = static_cast<u32>(instr.pred.pred_index);
-            single_branch.condition.predicate = GetPredicate(pred_index, instr.negate_pred != 0);
+            const auto pred_index = state.program.GetPredicateIndex(offset);
+            single_branch.condition.predicate =
+                GetPredicate(pred_index, state.program.IsPredicateNegated(offset));
             if (single_branch.condition.predicate == Pred::NeverExecute) {
                 offset++;
                 continue;
@@ -301,8 +302,9 @@ std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address)
             if (instr.bra.constant_buffer != 0) {
                 return {ParseResult::AbnormalFlow, parse_info};
             }
-            const auto pred_index = static_cast<u32>(instr.pred.pred_index);
-            single_branch.condition.predicate = GetPredicate(pred_index, instr.negate_pred != 0);
+            const auto pred_index = state.program.GetPredicateIndex(offset);
+            single_branch.condition.predicate =
+                GetPredicate(pred_index, state.program.IsPredicateNegated(offset));
             if (single_branch.condition.predicate == Pred::NeverExecute) {
                 offset++;
                 continue;
@@ -332,8 +334,9 @@ std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address)
             return {ParseResult::ControlCaught, parse_info};
         }
         case OpCode::Id::SYNC: {
-            const auto pred_index = static_cast<u32>(instr.pred.pred_index);
-            single_branch.condition.predicate = GetPredicate(pred_index, instr.negate_pred != 0);
+            const auto pred_index = state.program.GetPredicateIndex(offset);
+            single_branch.condition.predicate =
+                GetPredicate(pred_index, state.program.IsPredicateNegated(offset));
             if (single_branch.condition.predicate == Pred::NeverExecute) {
                 offset++;
                 continue;
@@ -357,8 +360,9 @@ std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address)
             return {ParseResult::ControlCaught, parse_info};
         }
         case OpCode::Id::BRK: {
-            const auto pred_index = static_cast<u32>(instr.pred.pred_index);
-            single_branch.condition.predicate = GetPredicate(pred_index, instr.negate_pred != 0);
+            const auto pred_index = state.program.GetPredicateIndex(offset);
+            single_branch.condition.predicate =
+                GetPredicate(pred_index, state.program.IsPredicateNegated(offset));
             if (single_branch.condition.predicate == Pred::NeverExecute) {
                 offset++;
                 continue;
@@ -382,8 +386,9 @@ std::pair<ParseResult, ParseInfo> ParseCode(CFGRebuildState& state, u32 address)
             return {ParseResult::ControlCaught, parse_info};
         }
         case OpCode::Id::KIL: {
-            const auto pred_index = static_cast<u32>(instr.pred.pred_index);
-            single_branch.condition.predicate = GetPredicate(pred_index, instr.negate_pred != 0);
+            const auto pred_index = state.program.GetPredicateIndex(offset);
+            single_branch.condition.predicate =
+                GetPredicate(pred_index, state.program.IsPredicateNegated(offset));
             if (single_branch.condition.predicate == Pred::NeverExecute) {
                 offset++;
                 continue;
@@ -645,16 +650,17 @@ void DecompileShader(CFGRebuildState& state) {
 
 } // Anonymous namespace
 
-std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code, u32 start_address,
+std::unique_ptr<ShaderCharacteristics> ScanFlow(const DecodedProgram& program, u32 start_address,
                                                 const CompilerSettings& settings,
                                                 Registry& registry) {
+    ScopedDecodeTimer timer{settings.stats, &DecodeStats::scan_flow};
     auto result_out = std::make_unique<ShaderCharacteristics>();
     if (settings.depth == CompileDepth::BruteForce) {
         result_out->settings.depth = CompileDepth::BruteForce;
         return result_out;
     }
 
-    CFGRebuildState state{program_code, start_address, registry};
+    CFGRebuildState state{program, start_address, registry};
     // Inspect Code and generate blocks
     state.labels.clear();
     state.labels.emplace(start_address);
@@ -687,11 +693,17 @@ std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
     // Sort and organize results
     std::sort(state.block_info.begin(), state.block_info.end(),
               [](const BlockInfo& a, const BlockInfo& b) -> bool { return a.start < b.start; });
+    if (settings.stats) {
+        settings.stats->flow_blocks = static_cast<u32>(state.block_info.size());
+    }
     if (decompiled && settings.depth != CompileDepth::NoFlowStack) {
         ASTManager manager{settings.depth != CompileDepth::DecompileBackwards,
                            settings.disable_else_derivation};
         state.manager = &manager;
-        DecompileShader(state);
+        {
+            ScopedDecodeTimer ast_timer{settings.stats, &DecodeStats::ast_decompile};
+            DecompileShader(state);
+        }
         decompiled = state.manager->IsFullyDecompiled();
         if (!decompiled) {
             if (settings.depth == CompileDepth::FullDecompile) {
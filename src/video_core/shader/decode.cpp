@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstring>
 #include <limits>
 #include <set>
+#include <utility>
 
 #include <fmt/format.h>
 
@@ -128,13 +130,17 @@ private:
 };
 
 void ShaderIR::Decode() {
-    std::memcpy(&header, program_code.data(), sizeof(Tegra::Shader::Header));
+    ScopedDecodeTimer timer{settings.stats, &DecodeStats::decode};
+    std::memcpy(&header, program.GetCode().data(), sizeof(Tegra::Shader::Header));
 
     decompiled = false;
-    auto info = ScanFlow(program_code, main_offset, settings, registry);
+    auto info = ScanFlow(program, main_offset, settings, registry);
     auto& shader_info = *info;
     coverage_begin = shader_info.start;
     coverage_end = shader_info.end;
+    if (settings.stats) {
+        settings.stats->depth = shader_info.settings.depth;
+    }
     switch (shader_info.settings.depth) {
     case CompileDepth::FlowStack: {
         for (const auto& block : shader_info.blocks) {
@@ -183,7 +189,7 @@ void ShaderIR::Decode() {
         LOG_CRITICAL(HW_GPU, "Unknown decompilation mode!");
         [[fallthrough]];
     case CompileDepth::BruteForce: {
-        const auto shader_end = static_cast<u32>(program_code.size());
+        const auto shader_end = static_cast<u32>(program.size());
         coverage_begin = main_offset;
         coverage_end = shader_end;
         for (u32 label = main_offset; label < shader_end; ++label) {
@@ -206,9 +212,13 @@ NodeBlock ShaderIR::DecodeRange(u32 begin, u32 end) {
 }
 
 void ShaderIR::DecodeRangeInner(NodeBlock& bb, u32 begin, u32 end) {
-    for (u32 pc = begin; pc < (begin > end ? MAX_PROGRAM_LENGTH : end);) {
+    u32 decoded_instructions = 0;
+    for (u32 pc = begin; pc < (begin > end ? MAX_PROGRAM_LENGTH : end); ++decoded_instructions) {
         pc = DecodeInstr(bb, pc);
     }
+    if (settings.stats) {
+        settings.stats->decoded_instructions += decoded_instructions;
+    }
 }
 
 void ShaderIR::InsertControlFlow(NodeBlock& bb, const ShaderBlock& block) {
@@ -264,74 +274,86 @@ void ShaderIR::InsertControlFlow(NodeBlock& bb, const ShaderBlock& block) {
 
 u32 ShaderIR::DecodeInstr(NodeBlock& bb, u32 pc) {
     // Ignore sched instructions when generating code.
-    if (IsSchedInstruction(pc, main_offset)) {
+    if (program.IsSched(pc)) {
         return pc + 1;
     }
 
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
-    const u32 nv_address = ConvertAddressToNvidiaSpace(pc);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     // Decoding failure
     if (!opcode) {
         UNIMPLEMENTED_MSG("Unhandled instruction: {0:x}", instr.value);
-        bb.push_back(Comment(fmt::format("{:05x} Unimplemented Shader instruction (0x{:016x})",
-                                         nv_address, instr.value)));
+        if (settings.emit_comments) {
+            bb.push_back(Comment(fmt::format("{:05x} Unimplemented Shader instruction (0x{:016x})",
+                                             ConvertAddressToNvidiaSpace(pc), instr.value)));
+        }
         return pc + 1;
     }
 
-    bb.push_back(Comment(
-        fmt::format("{:05x} {} (0x{:016x})", nv_address, opcode->get().GetName(), instr.value)));
+    if (settings.emit_comments) {
+        bb.push_back(Comment(fmt::format("{:05x} {} (0x{:016x})", ConvertAddressToNvidiaSpace(pc),
+                                         opcode->get().GetName(), instr.value)));
+    }
 
     using Tegra::Shader::Pred;
-    UNIMPLEMENTED_IF_MSG(instr.pred.full_pred == Pred::NeverExecute,
+    // Read ahead of the handlers, they move pc past the instructions they consume
+    const auto pred_index = program.GetPredicateIndex(pc);
+    const bool pred_negated = program.IsPredicateNegated(pc);
+    UNIMPLEMENTED_IF_MSG(pred_index == static_cast<u32>(Pred::UnusedIndex) && pred_negated,
                          "NeverExecute predicate not implemented");
-
-    static const std::map<OpCode::Type, u32 (ShaderIR::*)(NodeBlock&, u32)> decoders = {
-        {OpCode::Type::Arithmetic, &ShaderIR::DecodeArithmetic},
-        {OpCode::Type::ArithmeticImmediate, &ShaderIR::DecodeArithmeticImmediate},
-        {OpCode::Type::Bfe, &ShaderIR::DecodeBfe},
-        {OpCode::Type::Bfi, &ShaderIR::DecodeBfi},
-        {OpCode::Type::Shift, &ShaderIR::DecodeShift},
-        {OpCode::Type::ArithmeticInteger, &ShaderIR::DecodeArithmeticInteger},
-        {OpCode::Type::ArithmeticIntegerImmediate, &ShaderIR::DecodeArithmeticIntegerImmediate},
-        {OpCode::Type::ArithmeticHalf, &ShaderIR::DecodeArithmeticHalf},
-        {OpCode::Type::ArithmeticHalfImmediate, &ShaderIR::DecodeArithmeticHalfImmediate},
-        {OpCode::Type::Ffma, &ShaderIR::DecodeFfma},
-        {OpCode::Type::Hfma2, &ShaderIR::DecodeHfma2},
-        {OpCode::Type::Conversion, &ShaderIR::DecodeConversion},
-        {OpCode::Type::Warp, &ShaderIR::DecodeWarp},
-        {OpCode::Type::Memory, &ShaderIR::DecodeMemory},
-        {OpCode::Type::Texture, &ShaderIR::DecodeTexture},
-        {OpCode::Type::Image, &ShaderIR::DecodeImage},
-        {OpCode::Type::FloatSetPredicate, &ShaderIR::DecodeFloatSetPredicate},
-        {OpCode::Type::IntegerSetPredicate, &ShaderIR::DecodeIntegerSetPredicate},
-        {OpCode::Type::HalfSetPredicate, &ShaderIR::DecodeHalfSetPredicate},
-        {OpCode::Type::PredicateSetRegister, &ShaderIR::DecodePredicateSetRegister},
-        {OpCode::Type::PredicateSetPredicate, &ShaderIR::DecodePredicateSetPredicate},
-        {OpCode::Type::RegisterSetPredicate, &ShaderIR::DecodeRegisterSetPredicate},
-        {OpCode::Type::FloatSet, &ShaderIR::DecodeFloatSet},
-        {OpCode::Type::IntegerSet, &ShaderIR::DecodeIntegerSet},
-        {OpCode::Type::HalfSet, &ShaderIR::DecodeHalfSet},
-        {OpCode::Type::Video, &ShaderIR::DecodeVideo},
-        {OpCode::Type::Xmad, &ShaderIR::DecodeXmad},
-    };
-
-    std::vector<Node> tmp_block;
-    if (const auto decoder = decoders.find(opcode->get().GetType()); decoder != decoders.end()) {
-        pc = (this->*decoder->second)(tmp_block, pc);
-    } else {
-        pc = DecodeOther(tmp_block, pc);
-    }
-
     // Some instructions (like SSY) don't have a predicate field, they are always unconditionally
     // executed.
-    const bool can_be_predicated = OpCode::IsPredicatedInstruction(opcode->get().GetId());
-    const auto pred_index = static_cast<u32>(instr.pred.pred_index);
+    const bool can_be_predicated = OpCode::IsPredicatedInstruction(program.GetId(pc));
+
+    using Decoder = u32 (ShaderIR::*)(NodeBlock&, u32);
+    // Indexed by the opcode type, types without a handler of their own go to DecodeOther
+    static constexpr auto decoders = [] {
+        constexpr std::pair<OpCode::Type, Decoder> handlers[] = {
+            {OpCode::Type::Arithmetic, &ShaderIR::DecodeArithmetic},
+            {OpCode::Type::ArithmeticImmediate, &ShaderIR::DecodeArithmeticImmediate},
+            {OpCode::Type::Bfe, &ShaderIR::DecodeBfe},
+            {OpCode::Type::Bfi, &ShaderIR::DecodeBfi},
+            {OpCode::Type::Shift, &ShaderIR::DecodeShift},
+            {OpCode::Type::ArithmeticInteger, &ShaderIR::DecodeArithmeticInteger},
+            {OpCode::Type::ArithmeticIntegerImmediate, &ShaderIR::DecodeArithmeticIntegerImmediate},
+            {OpCode::Type::ArithmeticHalf, &ShaderIR::DecodeArithmeticHalf},
+            {OpCode::Type::ArithmeticHalfImmediate, &ShaderIR::DecodeArithmeticHalfImmediate},
+            {OpCode::Type::Ffma, &ShaderIR::DecodeFfma},
+            {OpCode::Type::Hfma2, &ShaderIR::DecodeHfma2},
+            {OpCode::Type::Conversion, &ShaderIR::DecodeConversion},
+            {OpCode::Type::Warp, &ShaderIR::DecodeWarp},
+            {OpCode::Type::Memory, &ShaderIR::DecodeMemory},
+            {OpCode::Type::Texture, &ShaderIR::DecodeTexture},
+            {OpCode::Type::Image, &ShaderIR::DecodeImage},
+            {OpCode::Type::FloatSetPredicate, &ShaderIR::DecodeFloatSetPredicate},
+            {OpCode::Type::IntegerSetPredicate, &ShaderIR::DecodeIntegerSetPredicate},
+            {OpCode::Type::HalfSetPredicate, &ShaderIR::DecodeHalfSetPredicate},
+            {OpCode::Type::PredicateSetRegister, &ShaderIR::DecodePredicateSetRegister},
+            {OpCode::Type::PredicateSetPredicate, &ShaderIR::DecodePredicateSetPredicate},
+            {OpCode::Type::RegisterSetPredicate, &ShaderIR::DecodeRegisterSetPredicate},
+            {OpCode::Type::FloatSet, &ShaderIR::DecodeFloatSet},
+            {OpCode::Type::IntegerSet, &ShaderIR::DecodeIntegerSet},
+            {OpCode::Type::HalfSet, &ShaderIR::DecodeHalfSet},
+            {OpCode::Type::Video, &ShaderIR::DecodeVideo},
+            {OpCode::Type::Xmad, &ShaderIR::DecodeXmad},
+        };
+        std::array<Decoder, static_cast<std::size_t>(OpCode::Type::Unknown) + 1> table{};
+        for (auto& decoder : table) {
+            decoder = &ShaderIR::DecodeOther;
+        }
+        for (const auto& handler : handlers) {
+            table[static_cast<std::size_t>(handler.first)] = handler.second;
+        }
+        return table;
+    }();
+
+    std::vector<Node> tmp_block;
+    pc = (this->*decoders[static_cast<std::size_t>(program.GetType(pc))])(tmp_block, pc);
 
     if (can_be_predicated && pred_index != static_cast<u32>(Pred::UnusedIndex)) {
         const Node conditional =
-            Conditional(GetPredicate(pred_index, instr.negate_pred != 0), std::move(tmp_block));
+            Conditional(GetPredicate(pred_index, pred_negated), std::move(tmp_block));
         global_code.push_back(conditional);
         bb.push_back(conditional);
     } else {
@@ -345,6 +367,7 @@ u32 ShaderIR::DecodeInstr(NodeBlock& bb, u32 pc) {
 }
 
 void ShaderIR::PostDecode() {
+    ScopedDecodeTimer timer{settings.stats, &DecodeStats::post_decode};
     // Deduce texture handler size if needed
     auto gpu_driver = registry.AccessGuestDriverProfile();
     DeduceTextureHandlerSize(gpu_driver, used_samplers);
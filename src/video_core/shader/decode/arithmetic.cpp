@@ -16,8 +16,8 @@ using Tegra::Shader::OpCode;
 using Tegra::Shader::SubOp;
 
 u32 ShaderIR::DecodeArithmetic(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node op_a = GetRegister(instr.gpr8);
 
@@ -16,8 +16,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeArithmeticHalf(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     bool negate_a = false;
     bool negate_b = false;
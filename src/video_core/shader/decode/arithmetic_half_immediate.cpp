@@ -15,8 +15,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeArithmeticHalfImmediate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     if (opcode->get().GetId() == OpCode::Id::HADD2_IMM) {
         if (instr.alu_half_imm.ftz == 0) {
@@ -14,8 +14,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeArithmeticImmediate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     switch (opcode->get().GetId()) {
     case OpCode::Id::MOV32_IMM: {
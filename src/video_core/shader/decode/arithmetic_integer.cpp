@@ -17,8 +17,8 @@ using Tegra::Shader::Pred;
 using Tegra::Shader::Register;
 
 u32 ShaderIR::DecodeArithmeticInteger(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node op_a = GetRegister(instr.gpr8);
     Node op_b = [&]() {
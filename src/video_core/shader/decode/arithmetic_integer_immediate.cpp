@@ -18,8 +18,8 @@ using Tegra::Shader::PredicateResultMode;
 using Tegra::Shader::Register;
 
 u32 ShaderIR::DecodeArithmeticIntegerImmediate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node op_a = GetRegister(instr.gpr8);
     Node op_b = Immediate(static_cast<s32>(instr.alu.imm20_32));
@@ -14,8 +14,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeBfe(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node op_a = GetRegister(instr.gpr8);
     Node op_b = [&] {
@@ -14,8 +14,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeBfi(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     const auto [packed_shift, base] = [&]() -> std::pair<Node, Node> {
         switch (opcode->get().GetId()) {
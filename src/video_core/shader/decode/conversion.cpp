@@ -65,8 +65,8 @@ constexpr std::optional<std::pair<s32, s32>> IntegerSaturateBounds(Register::Siz
 } // Anonymous namespace
 
 u32 ShaderIR::DecodeConversion(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     switch (opcode->get().GetId()) {
     case OpCode::Id::I2I_R:
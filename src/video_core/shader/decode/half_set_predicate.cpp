@@ -16,8 +16,8 @@ using Tegra::Shader::OpCode;
 using Tegra::Shader::Pred;
 
 u32 ShaderIR::DecodeHalfSetPredicate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     if (instr.hsetp2.ftz != 0) {
         LOG_DEBUG(HW_GPU, "{} without FTZ is not implemented", opcode->get().GetName());
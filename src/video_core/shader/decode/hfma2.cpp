@@ -18,8 +18,8 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeHfma2(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     if (opcode->get().GetId() == OpCode::Id::HFMA2_RR) {
         DEBUG_ASSERT(instr.hfma2.rr.precision == HalfPrecision::None);
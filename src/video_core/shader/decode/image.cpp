@@ -313,8 +313,8 @@ std::pair<Node, bool> ShaderIR::GetComponentValue(ComponentType component_type,
 }
 
 u32 ShaderIR::DecodeImage(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     const auto GetCoordinates = [this, instr](Tegra::Shader::ImageType image_type) {
         std::vector<Node> coords;
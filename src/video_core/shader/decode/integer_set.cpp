@@ -13,7 +13,7 @@ using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
 u32 ShaderIR::DecodeIntegerSet(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
+    const Instruction instr = program.GetInstruction(pc);
 
     const Node op_a = GetRegister(instr.gpr8);
     const Node op_b = [&]() {
@@ -15,7 +15,7 @@ using Tegra::Shader::OpCode;
 using Tegra::Shader::Pred;
 
 u32 ShaderIR::DecodeIntegerSetPredicate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
+    const Instruction instr = program.GetInstruction(pc);
 
     const Node op_a = GetRegister(instr.gpr8);
 
@@ -111,8 +111,8 @@ Node Sign16Extend(Node value) {
 } // Anonymous namespace
 
 u32 ShaderIR::DecodeMemory(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     switch (opcode->get().GetId()) {
     case OpCode::Id::LD_A: {
@@ -475,7 +475,9 @@ std::tuple<Node, Node, GlobalMemoryBase> ShaderIR::TrackGlobalMemory(NodeBlock&
                           { return std::make_tuple(nullptr, nullptr, GlobalMemoryBase{}); },
                           "Global memory tracking failed");
 
-    bb.push_back(Comment(fmt::format("Base address is c[0x{:x}][0x{:x}]", index, offset)));
+    if (settings.emit_comments) {
+        bb.push_back(Comment(fmt::format("Base address is c[0x{:x}][0x{:x}]", index, offset)));
+    }
 
     const GlobalMemoryBase descriptor{index, offset};
     const auto& entry = used_global_memory.try_emplace(descriptor).first;
@@ -23,8 +23,8 @@ using Tegra::Shader::SystemVariable;
 using Index = Tegra::Shader::Attribute::Index;
 
 u32 ShaderIR::DecodeOther(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     switch (opcode->get().GetId()) {
     case OpCode::Id::NOP: {
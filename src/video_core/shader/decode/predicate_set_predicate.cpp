@@ -15,8 +15,8 @@ using Tegra::Shader::OpCode;
 using Tegra::Shader::Pred;
 
 u32 ShaderIR::DecodePredicateSetPredicate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     switch (opcode->get().GetId()) {
     case OpCode::Id::PSETP: {
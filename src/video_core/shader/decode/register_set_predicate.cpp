@@ -22,8 +22,8 @@ constexpr u64 NUM_PREDICATES = 7;
 } // namespace
 
 u32 ShaderIR::DecodeRegisterSetPredicate(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node apply_mask = [this, opcode, instr] {
         switch (opcode->get().GetId()) {
@@ -85,8 +85,8 @@ Node ShiftLeft(Node low, Node high, Node shift, Node low_shift, ShfType type) {
 } // Anonymous namespace
 
 u32 ShaderIR::DecodeShift(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     Node op_a = GetRegister(instr.gpr8);
     Node op_b = [this, instr] {
@@ -20,8 +20,8 @@ using Tegra::Shader::VmnmxOperation;
 using Tegra::Shader::VmnmxType;
 
 u32 ShaderIR::DecodeVideo(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     if (opcode->get().GetId() == OpCode::Id::VMNMX) {
         DecodeVMNMX(bb, instr);
@@ -35,8 +35,8 @@ OperationCode GetOperationCode(VoteOperation vote_op) {
 } // Anonymous namespace
 
 u32 ShaderIR::DecodeWarp(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     // Signal the backend that this shader uses warp instructions.
     uses_warps = true;
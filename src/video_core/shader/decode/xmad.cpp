@@ -15,8 +15,8 @@ using Tegra::Shader::OpCode;
 using Tegra::Shader::PredCondition;
 
 u32 ShaderIR::DecodeXmad(NodeBlock& bb, u32 pc) {
-    const Instruction instr = {program_code[pc]};
-    const auto opcode = OpCode::Decode(instr);
+    const Instruction instr = program.GetInstruction(pc);
+    const auto opcode = program.GetOpcode(pc);
 
     UNIMPLEMENTED_IF(instr.xmad.sign_a);
     UNIMPLEMENTED_IF(instr.xmad.sign_b);
@@ -0,0 +1,29 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/shader/decoded_program.h"
+
+namespace VideoCommon::Shader {
+
+using Tegra::Shader::Instruction;
+using Tegra::Shader::OpCode;
+
+DecodedProgram::DecodedProgram(ProgramCodeView code, u32 main_offset)
+    : code{code}, matchers(code.size()), ids(code.size()), types(code.size()),
+      sched(code.size()), predicates(code.size()) {
+    for (u32 pc = 0; pc < code.size(); ++pc) {
+        const Instruction instr = {code[pc]};
+        // Scheduler words are decoded too, so GetOpcode matches OpCode::Decode at every offset
+        const u8 index = OpCode::DecodeIndex(instr);
+        matchers[pc] = index;
+        if (index != 0) {
+            const OpCode::Matcher& matcher = OpCode::GetMatcher(index);
+            ids[pc] = static_cast<u16>(matcher.GetId());
+            types[pc] = static_cast<u8>(matcher.GetType());
+        }
+        sched[pc] = IsSchedInstruction(pc, main_offset) ? 1 : 0;
+        predicates[pc] = static_cast<u8>(instr.pred.full_pred.Value());
+    }
+}
+
+} // namespace VideoCommon::Shader
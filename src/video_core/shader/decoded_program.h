@@ -0,0 +1,82 @@
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/engines/shader_bytecode.h"
+#include "video_core/shader/memory_util.h"
+
+namespace VideoCommon::Shader {
+
+/**
+ * Program stream decoded once ahead of the control flow analysis and the IR generation. Every
+ * property the passes look up per instruction is stored in its own array indexed by the
+ * instruction offset, the raw words are read from the viewed program stream.
+ */
+class DecodedProgram {
+public:
+    explicit DecodedProgram(ProgramCodeView code, u32 main_offset);
+
+    /// Returns the program stream the instructions were decoded from
+    ProgramCodeView GetCode() const {
+        return code;
+    }
+
+    std::size_t size() const {
+        return code.size();
+    }
+
+    Tegra::Shader::Instruction GetInstruction(u32 pc) const {
+        return {code[pc]};
+    }
+
+    /// Returns whether the instruction at the offset is a scheduler instruction
+    bool IsSched(u32 pc) const {
+        return sched[pc] != 0;
+    }
+
+    /// Returns the matcher of the instruction at the offset, or nullopt if its opcode is unknown
+    std::optional<std::reference_wrapper<const Tegra::Shader::OpCode::Matcher>> GetOpcode(
+        u32 pc) const {
+        if (matchers[pc] == 0) {
+            return std::nullopt;
+        }
+        return Tegra::Shader::OpCode::GetMatcher(matchers[pc]);
+    }
+
+    /// Returns the opcode id of a known instruction
+    Tegra::Shader::OpCode::Id GetId(u32 pc) const {
+        return static_cast<Tegra::Shader::OpCode::Id>(ids[pc]);
+    }
+
+    /// Returns the opcode type of a known instruction
+    Tegra::Shader::OpCode::Type GetType(u32 pc) const {
+        return static_cast<Tegra::Shader::OpCode::Type>(types[pc]);
+    }
+
+    /// Returns the execution predicate index of the instruction
+    u32 GetPredicateIndex(u32 pc) const {
+        return predicates[pc] & 0x7U;
+    }
+
+    /// Returns whether the execution predicate of the instruction is negated
+    bool IsPredicateNegated(u32 pc) const {
+        return (predicates[pc] & 0x8U) != 0;
+    }
+
+private:
+    ProgramCodeView code;
+    std::vector<u8> matchers;
+    std::vector<u16> ids;
+    std::vector<u8> types;
+    std::vector<u8> sched;
+    std::vector<u8> predicates;
+};
+
+} // namespace VideoCommon::Shader
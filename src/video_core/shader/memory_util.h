@@ -23,6 +23,42 @@ namespace VideoCommon::Shader {
 
 using ProgramCode = std::vector<u64>;
 
+/// Non-owning view over a program stream, e.g. a ProgramCode or a memory mapped file.
+class ProgramCodeView {
+public:
+    constexpr ProgramCodeView() = default;
+    constexpr ProgramCodeView(const u64* code, std::size_t length) : code{code}, length{length} {}
+    ProgramCodeView(const ProgramCode& program) : code{program.data()}, length{program.size()} {}
+
+    constexpr const u64& operator[](std::size_t index) const {
+        return code[index];
+    }
+
+    constexpr const u64* data() const {
+        return code;
+    }
+
+    constexpr std::size_t size() const {
+        return length;
+    }
+
+    constexpr bool empty() const {
+        return length == 0;
+    }
+
+    constexpr const u64* begin() const {
+        return code;
+    }
+
+    constexpr const u64* end() const {
+        return code + length;
+    }
+
+private:
+    const u64* code = nullptr;
+    std::size_t length = 0;
+};
+
 constexpr u32 STAGE_MAIN_OFFSET = 10;
 constexpr u32 KERNEL_MAIN_OFFSET = 0;
 
@@ -25,9 +25,10 @@ using Tegra::Shader::PredCondition;
 using Tegra::Shader::PredOperation;
 using Tegra::Shader::Register;
 
-ShaderIR::ShaderIR(const ProgramCode& program_code, u32 main_offset, CompilerSettings settings,
+ShaderIR::ShaderIR(ProgramCodeView program_code, u32 main_offset, CompilerSettings settings,
                    Registry& registry)
-    : program_code{program_code}, main_offset{main_offset}, settings{settings}, registry{registry} {
+    : program{program_code, main_offset}, main_offset{main_offset}, settings{settings},
+      registry{registry} {
     Decode();
     PostDecode();
 }
@@ -120,13 +121,40 @@ Node ShaderIR::GetInternalFlag(InternalFlag flag, bool negated) const {
 }
 
 Node ShaderIR::GetLocalMemory(Node address) {
+    TrackMemoryAccess(local_memory_size, address);
     return MakeNode<LmemNode>(std::move(address));
 }
 
 Node ShaderIR::GetSharedMemory(Node address) {
+    TrackMemoryAccess(shared_memory_size, address);
     return MakeNode<SmemNode>(std::move(address));
 }
 
+void ShaderIR::TrackMemoryAccess(std::optional<u32>& size, const Node& address) {
+    if (!size) {
+        return;
+    }
+    // Constant addresses are immediates, or immediates added to RZ
+    std::optional<u32> offset;
+    if (const auto immediate = std::get_if<ImmediateNode>(&*address)) {
+        offset = immediate->GetValue();
+    } else if (const auto operation = std::get_if<OperationNode>(&*address);
+               operation && operation->GetCode() == OperationCode::IAdd &&
+               operation->GetOperandsCount() == 2) {
+        const auto gpr = std::get_if<GprNode>(&*(*operation)[0]);
+        const auto immediate = std::get_if<ImmediateNode>(&*(*operation)[1]);
+        if (gpr && immediate && gpr->GetIndex() == static_cast<u32>(Register::ZeroIndex)) {
+            offset = immediate->GetValue();
+        }
+    }
+    // Negative offsets wrap around, treat them like dynamic addresses
+    if (!offset || static_cast<s32>(*offset) < 0) {
+        size.reset();
+        return;
+    }
+    *size = std::max(*size, *offset + 4);
+}
+
 Node ShaderIR::GetTemporary(u32 id) {
     return GetRegister(Register::ZeroIndex + 1 + id);
 }
@@ -18,6 +18,7 @@
 #include "video_core/engines/shader_header.h"
 #include "video_core/shader/ast.h"
 #include "video_core/shader/compiler_settings.h"
+#include "video_core/shader/decoded_program.h"
 #include "video_core/shader/memory_util.h"
 #include "video_core/shader/node.h"
 #include "video_core/shader/registry.h"
@@ -66,7 +67,7 @@ struct GlobalMemoryUsage {
 
 class ShaderIR final {
 public:
-    explicit ShaderIR(const ProgramCode& program_code, u32 main_offset, CompilerSettings settings,
+    explicit ShaderIR(ProgramCodeView program_code, u32 main_offset, CompilerSettings settings,
                       Registry& registry);
     ~ShaderIR();
 
@@ -151,6 +152,18 @@ public:
         return header;
     }
 
+    /// Returns the bytes of local memory accessed by the shader, or nullopt if an access uses an
+    /// address that isn't known at compile time.
+    std::optional<u32> GetLocalMemorySize() const {
+        return local_memory_size;
+    }
+
+    /// Returns the bytes of shared memory accessed by the shader, or nullopt if an access uses an
+    /// address that isn't known at compile time.
+    std::optional<u32> GetSharedMemorySize() const {
+        return shared_memory_size;
+    }
+
     bool IsFlowStackDisabled() const {
         return disable_flow_stack;
     }
@@ -275,6 +288,9 @@ private:
     /// Generates a temporary, internally it uses a post-RZ register
     Node GetTemporary(u32 id);
 
+    /// Grows a tracked memory size to cover a 32-bit access at address
+    void TrackMemoryAccess(std::optional<u32>& size, const Node& address);
+
     /// Sets a register. src value must be a number-evaluated node.
     void SetRegister(NodeBlock& bb, Tegra::Shader::Register dest, Node src);
     /// Sets a predicate. src value must be a bool-evaluated node
@@ -432,7 +448,7 @@ private:
 
     u32 NewCustomVariable();
 
-    const ProgramCode& program_code;
+    const DecodedProgram program;
     const u32 main_offset;
     const CompilerSettings settings;
     Registry& registry;
@@ -467,6 +483,8 @@ private:
     bool uses_legacy_varyings{};
     bool uses_warps{};
     bool uses_indexed_samplers{};
+    std::optional<u32> local_memory_size{0};
+    std::optional<u32> shared_memory_size{0};
 
     Tegra::Shader::Header header;
 };
@@ -403,7 +403,7 @@ private:
         DeclareInputAttributes();
         DeclareOutputAttributes();
 
-        u32 binding = specialization.base_binding;
+        u32 binding = specialization.base_binding + GetFixedBindingCount();
         binding = DeclareConstantBuffers(binding);
         binding = DeclareGlobalBuffers(binding);
         binding = DeclareUniformTexels(binding);
@@ -670,9 +670,8 @@ private:
     }
 
     void DeclareLocalMemory() {
-        // TODO(Rodrigo): Unstub kernel local memory size and pass it from a
-        // register at specialization time.
-        const u64 lmem_size = stage == ShaderType::Compute ? 0x400 : header.GetLocalMemorySize();
+        const u64 lmem_size = stage == ShaderType::Compute ? specialization.local_memory_size
+                                                           : header.GetLocalMemorySize();
         if (lmem_size == 0) {
             return;
         }
@@ -831,7 +830,7 @@ private:
 
         UNIMPLEMENTED_IF(registry.GetGraphicsInfo().tfb_enabled && stage != ShaderType::Vertex);
         for (const auto index : ir.GetOutputAttributes()) {
-            if (!IsGenericAttribute(index)) {
+            if (!IsGenericAttribute(index) || !IsVaryingLinked(GetGenericAttributeLocation(index))) {
                 continue;
             }
             DeclareOutputAttribute(index);
@@ -907,6 +906,26 @@ private:
         return it->second;
     }
 
+    u32 GetFixedBindingCount() const {
+        u32 count = 0;
+        for (const auto* bindings : {&specialization.const_buffer_bindings,
+                                     &specialization.texture_bindings,
+                                     &specialization.sampler_bindings}) {
+            for (const auto& [key, fixed_binding] : *bindings) {
+                count = std::max(count, fixed_binding + 1);
+            }
+        }
+        return count;
+    }
+
+    /// Returns the fixed binding of a resource, or takes the next sequential one
+    u32 TakeBinding(const std::map<u32, u32>& fixed_bindings, u32 key, u32& binding) const {
+        if (const auto it = fixed_bindings.find(key); it != fixed_bindings.end()) {
+            return specialization.base_binding + it->second;
+        }
+        return binding++;
+    }
+
     u32 DeclareConstantBuffers(u32 binding) {
         for (const auto& [index, size] : ir.GetConstantBuffers()) {
             const Id type = t_cbuf_std140_ubo;
@@ -915,7 +934,8 @@ private:
             AddGlobalVariable(Name(id, fmt::format("cbuf_{}", index)));
 
             Decorate(id, spv::Decoration::NonWritable);
-            Decorate(id, spv::Decoration::Binding, binding++);
+            Decorate(id, spv::Decoration::Binding,
+                     TakeBinding(specialization.const_buffer_bindings, index, binding));
             Decorate(id, spv::Decoration::DescriptorSet, DESCRIPTOR_SET);
             constant_buffers.emplace(index, id);
         }
@@ -953,7 +973,8 @@ private:
             const Id pointer_type = TypePointer(spv::StorageClass::UniformConstant, image_type);
             const Id id = OpVariable(pointer_type, spv::StorageClass::UniformConstant);
             AddGlobalVariable(Name(id, fmt::format("sampler_{}", sampler.index)));
-            Decorate(id, spv::Decoration::Binding, binding++);
+            Decorate(id, spv::Decoration::Binding,
+                     TakeBinding(specialization.texture_bindings, sampler.index, binding));
             Decorate(id, spv::Decoration::DescriptorSet, DESCRIPTOR_SET);
 
             uniform_texels.emplace(sampler.index, TexelBuffer{image_type, id});
@@ -972,7 +993,8 @@ private:
             const Id pointer_type = TypePointer(spv::StorageClass::UniformConstant, image_type);
             const Id id = OpVariable(pointer_type, spv::StorageClass::UniformConstant);
             AddGlobalVariable(Name(id, fmt::format("sampler_{}", sampler.index)));
-            Decorate(id, spv::Decoration::Binding, binding++);
+            Decorate(id, spv::Decoration::Binding,
+                     TakeBinding(specialization.sampler_bindings, sampler.index, binding));
             Decorate(id, spv::Decoration::DescriptorSet, DESCRIPTOR_SET);
 
             samplers.emplace(sampler.index,
@@ -1002,7 +1024,8 @@ private:
             const Id pointer_type = TypePointer(spv::StorageClass::UniformConstant, type);
             const Id id = OpVariable(pointer_type, spv::StorageClass::UniformConstant);
             AddGlobalVariable(Name(id, fmt::format("texture_{}", sampler.index)));
-            Decorate(id, spv::Decoration::Binding, binding++);
+            Decorate(id, spv::Decoration::Binding,
+                     TakeBinding(specialization.texture_bindings, sampler.index, binding));
             Decorate(id, spv::Decoration::DescriptorSet, DESCRIPTOR_SET);
 
             sampled_images.emplace(sampler.index,
@@ -1072,7 +1095,14 @@ private:
     }
 
     bool IsAttributeEnabled(u32 location) const {
-        return stage != ShaderType::Vertex || specialization.enabled_attributes[location];
+        if (stage == ShaderType::Vertex) {
+            return specialization.enabled_attributes[location];
+        }
+        return IsVaryingLinked(location);
+    }
+
+    bool IsVaryingLinked(u32 location) const {
+        return !specialization.linked_varyings || specialization.linked_varyings->test(location);
     }
 
     u32 GetNumInputVertices() const {
@@ -1526,6 +1556,10 @@ private:
                 }
                 default:
                     if (IsGenericAttribute(attribute)) {
+                        if (!IsVaryingLinked(GetGenericAttributeLocation(attribute))) {
+                            // Not read by the next stage, drop the store.
+                            return {};
+                        }
                         const u8 offset = static_cast<u8>(static_cast<u8>(attribute) * 4 + element);
                         const GenericVaryingDescription description = output_attributes.at(offset);
                         const Id composite = description.id;
@@ -3173,8 +3207,18 @@ ShaderEntries GenerateShaderEntries(const VideoCommon::Shader::ShaderIR& ir) {
 std::vector<u32> Decompile(const DeviceSettings& deviceSettings,
                            const VideoCommon::Shader::ShaderIR& ir, ShaderType stage,
                            const VideoCommon::Shader::Registry& registry,
-                           const Specialization& specialization) {
-    return SPIRVDecompiler(deviceSettings, ir, stage, registry, specialization).Assemble();
+                           const Specialization& specialization, DecodeStats* stats) {
+    std::optional<ScopedDecodeTimer> construct_timer{std::in_place, stats,
+                                                     &DecodeStats::spirv_construct};
+    SPIRVDecompiler decompiler(deviceSettings, ir, stage, registry, specialization);
+    construct_timer.reset();
+
+    ScopedDecodeTimer assemble_timer{stats, &DecodeStats::spirv_assemble};
+    std::vector<u32> code = decompiler.Assemble();
+    if (stats) {
+        stats->spirv_words += static_cast<u32>(code.size());
+    }
+    return code;
 }
 
 } // namespace VideoCommon::Shader
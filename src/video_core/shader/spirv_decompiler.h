@@ -5,6 +5,9 @@
 #pragma once
 
 #include <array>
+#include <bitset>
+#include <map>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -97,9 +100,16 @@ struct ShaderEntries {
 struct Specialization final {
     u32 base_binding{};
 
+    // Fixed bindings relative to base_binding, keyed by const buffer and emulated sampler index.
+    // Resources without one are bound sequentially after the highest fixed binding.
+    std::map<u32, u32> const_buffer_bindings;
+    std::map<u32, u32> texture_bindings;
+    std::map<u32, u32> sampler_bindings;
+
     // Compute specific
     std::array<u32, 3> workgroup_size{};
     u32 shared_memory_size{};
+    u32 local_memory_size{};
 
     // Graphics specific
     std::optional<float> point_size;
@@ -107,6 +117,11 @@ struct Specialization final {
     std::array<Maxwell::VertexAttribute::Type, Maxwell::NumVertexAttributes> attribute_types{};
     std::vector<u8> custom_input_varyings{};
     bool ndc_minus_one_to_one{};
+
+    // Generic varyings, one bit per location, that are both written by the previous stage and
+    // read by the next one in a linked pipeline. Varyings outside of it aren't declared, their
+    // stores are dropped and their loads return zero.
+    std::optional<std::bitset<32>> linked_varyings;
 };
 // Old gcc versions don't consider this trivially copyable.
 // static_assert(std::is_trivially_copyable_v<Specialization>);
@@ -121,6 +136,7 @@ ShaderEntries GenerateShaderEntries(const VideoCommon::Shader::ShaderIR& ir);
 std::vector<u32> Decompile(const DeviceSettings& deviceSettings, const VideoCommon::Shader::ShaderIR& ir,
                            Tegra::Engines::ShaderType stage,
                            const VideoCommon::Shader::Registry& registry,
-                           const Specialization& specialization);
+                           const Specialization& specialization,
+                           DecodeStats* stats = nullptr);
 
 } // namespace VideoCommon::Shader